@@ -0,0 +1,147 @@
+/**
+ * @file agenda.c
+ *
+ * @brief Implementação da agenda de prazos das palavras.
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#include "agenda.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @brief Coloca uma palavra em uma posição do heap.
+ *
+ * @param ag Agenda.
+ * @param i Posição no heap.
+ * @param palavra Número da palavra.
+ */
+static void agenda_poe(Agenda *ag, int i, int palavra)
+{
+  ag->heap[i] = palavra;
+  ag->pos[palavra] = i;
+}
+
+/**
+ * @brief Sobe a palavra da posição i enquanto seu prazo for menor que o do pai.
+ *
+ * @param ag Agenda.
+ * @param i Posição no heap.
+ */
+static void agenda_sobe(Agenda *ag, int i)
+{
+  int palavra = ag->heap[i];
+  while (i > 0) {
+    int pai = (i - 1) / 2;
+    if (ag->prazo[ag->heap[pai]] <= ag->prazo[palavra]) {
+      break;
+    }
+    agenda_poe(ag, i, ag->heap[pai]);
+    i = pai;
+  }
+  agenda_poe(ag, i, palavra);
+}
+
+/**
+ * @brief Desce a palavra da posição i enquanto seu prazo for maior que o de um filho.
+ *
+ * @param ag Agenda.
+ * @param i Posição no heap.
+ */
+static void agenda_desce(Agenda *ag, int i)
+{
+  int palavra = ag->heap[i];
+  while (true) {
+    int filho = 2 * i + 1;
+    if (filho >= ag->n) {
+      break;
+    }
+    if (filho + 1 < ag->n && ag->prazo[ag->heap[filho + 1]] < ag->prazo[ag->heap[filho]]) {
+      filho++;
+    }
+    if (ag->prazo[palavra] <= ag->prazo[ag->heap[filho]]) {
+      break;
+    }
+    agenda_poe(ag, i, ag->heap[filho]);
+    i = filho;
+  }
+  agenda_poe(ag, i, palavra);
+}
+
+void agenda_ini(Agenda *ag, int capacidade)
+{
+  ag->n = 0;
+  ag->capacidade = capacidade;
+  ag->prazo = malloc(capacidade * sizeof(double));
+  ag->heap = malloc(capacidade * sizeof(int));
+  ag->pos = malloc(capacidade * sizeof(int));
+  if (ag->prazo == NULL || ag->heap == NULL || ag->pos == NULL) {
+    perror("Sem memória para a agenda");
+    exit(1);
+  }
+  for (int i = 0; i < capacidade; i++) {
+    ag->pos[i] = -1;
+  }
+}
+
+void agenda_fim(Agenda *ag)
+{
+  free(ag->prazo);
+  free(ag->heap);
+  free(ag->pos);
+  ag->prazo = NULL;
+  ag->heap = ag->pos = NULL;
+  ag->n = ag->capacidade = 0;
+}
+
+void agenda_marca(Agenda *ag, int palavra, double prazo)
+{
+  int i = ag->pos[palavra];
+  if (i == -1) {
+    ag->prazo[palavra] = prazo;
+    agenda_poe(ag, ag->n, palavra);
+    ag->n++;
+    agenda_sobe(ag, ag->n - 1);
+  } else if (prazo < ag->prazo[palavra]) {
+    ag->prazo[palavra] = prazo;
+    agenda_sobe(ag, i);
+  } else {
+    ag->prazo[palavra] = prazo;
+    agenda_desce(ag, i);
+  }
+}
+
+void agenda_remove(Agenda *ag, int palavra)
+{
+  int i = ag->pos[palavra];
+  if (i == -1) {
+    return;
+  }
+  ag->pos[palavra] = -1;
+  ag->n--;
+  if (i == ag->n) {
+    return;
+  }
+  // a última palavra do heap ocupa o lugar da removida, e depois sobe ou desce
+  int ultima = ag->heap[ag->n];
+  agenda_poe(ag, i, ultima);
+  agenda_sobe(ag, i);
+  if (ag->pos[ultima] == i) {
+    agenda_desce(ag, i);
+  }
+}
+
+int agenda_primeira(const Agenda *ag)
+{
+  if (ag->n == 0) {
+    return -1;
+  }
+  return ag->heap[0];
+}
+
+double agenda_prazo(const Agenda *ag, int palavra)
+{
+  return ag->prazo[palavra];
+}
@@ -0,0 +1,81 @@
+/**
+ * @file agenda.h
+ *
+ * @brief Definição da agenda de prazos das palavras.
+ *
+ * A agenda é um heap binário de mínimo, indexado pelo número da palavra:
+ * cada palavra tem no máximo um prazo (a hora em que aparece ou a hora em
+ * que seu tempo de digitação acaba). Achar o menor prazo custa O(1);
+ * inserir, alterar e remover custam O(log n).
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#ifndef AGENDA_H
+#define AGENDA_H
+
+#include <stdbool.h>
+
+/**
+ * @brief Agenda de prazos.
+ *
+ * As palavras são identificadas por um número entre 0 e capacidade-1.
+ */
+typedef struct {
+  double *prazo;    /**< Prazo de cada palavra. */
+  int *heap;        /**< Palavras, organizadas como heap pelo prazo. */
+  int *pos;         /**< Posição de cada palavra no heap, ou -1. */
+  int n;            /**< Número de palavras na agenda. */
+  int capacidade;   /**< Número de palavras que a agenda comporta. */
+} Agenda;
+
+/**
+ * @brief Inicializa uma agenda vazia.
+ *
+ * @param ag Agenda.
+ * @param capacidade Número de palavras que a agenda deve comportar.
+ */
+void agenda_ini(Agenda *ag, int capacidade);
+
+/**
+ * @brief Libera a memória da agenda.
+ *
+ * @param ag Agenda.
+ */
+void agenda_fim(Agenda *ag);
+
+/**
+ * @brief Coloca uma palavra na agenda ou muda seu prazo, se ela já estiver lá.
+ *
+ * @param ag Agenda.
+ * @param palavra Número da palavra.
+ * @param prazo Novo prazo da palavra.
+ */
+void agenda_marca(Agenda *ag, int palavra, double prazo);
+
+/**
+ * @brief Tira uma palavra da agenda (se ela estiver lá).
+ *
+ * @param ag Agenda.
+ * @param palavra Número da palavra.
+ */
+void agenda_remove(Agenda *ag, int palavra);
+
+/**
+ * @brief Retorna a palavra com o menor prazo.
+ *
+ * @param ag Agenda.
+ * @return Número da palavra, ou -1 se a agenda estiver vazia.
+ */
+int agenda_primeira(const Agenda *ag);
+
+/**
+ * @brief Retorna o prazo de uma palavra que está na agenda.
+ *
+ * @param ag Agenda.
+ * @param palavra Número da palavra.
+ * @return Prazo da palavra.
+ */
+double agenda_prazo(const Agenda *ag, int palavra);
+
+#endif /* AGENDA_H */
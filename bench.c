@@ -0,0 +1,341 @@
+/**
+ * @file bench.c
+ *
+ * @brief Medição de desempenho das partes mais usadas do jogo.
+ *
+ * Mede a carga do dicionário, o sorteio das palavras, a seleção de palavra pela primeira
+ * letra, a verificação de expiração e o desenho de um quadro completo. O desenho é feito na
+ * tela em memória, em vários tamanhos de terminal e números de palavras.
+ * Também grava recordes a partir de muitos processos ao mesmo tempo e verifica se algum
+ * se perdeu; nesse caso, o programa termina com erro.
+ * O resultado é impresso em JSON, para ser comparado entre versões.
+ *
+ * @author Luiz Felipe Cavalheiro
+ *
+ * @note Para medir, digite: 'make bench'
+ */
+
+#include "funcoes.h"
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+
+#define N_TAMANHOS 3 /**< Número de tamanhos de terminal medidos. */
+#define N_QUANTIDADES 3 /**< Número de quantidades de palavras medidas. */
+#define QUADROS 2000 /**< Quadros desenhados em cada medição do desenho. */
+#define REPETICOES 200000 /**< Repetições das medições mais rápidas. */
+#define PROCESSOS 32 /**< Processos que gravam recordes ao mesmo tempo. */
+#define RECORDES_POR_PROCESSO 20 /**< Recordes gravados por cada processo. */
+
+static const int tamanhos[N_TAMANHOS][2] = { { 24, 80 }, { 50, 160 }, { 100, 300 } };
+static const int quantidades[N_QUANTIDADES] = { 10, 100, 700 };
+
+/** Impede que o compilador descarte o resultado das operações medidas. */
+static volatile long descarte;
+
+/** Se já foi impresso algum resultado (para separar com vírgula). */
+static bool primeiro = true;
+
+/**
+ * @brief Imprime o resultado de uma medição, em JSON.
+ *
+ * @param nome Nome da medição.
+ * @param palavras Número de palavras em jogo, ou 0 se não se aplica.
+ * @param iteracoes Número de operações medidas.
+ * @param segundos Tempo gasto nas operações.
+ * @param estat Contadores da tela durante a medição, ou NULL se não houve desenho.
+ */
+static void resultado(const char *nome, int palavras, long iteracoes, double segundos,
+                      const tela_estatisticas_t *estat)
+{
+  printf("%s\n    {\"nome\": \"%s\", \"palavras\": %d, \"iteracoes\": %ld, \"ns_por_op\": %.1f",
+         primeiro ? "" : ",", nome, palavras, iteracoes, segundos * 1e9 / iteracoes);
+  if (estat != NULL) {
+    printf(", \"bytes_por_quadro\": %.1f, \"escritas_por_quadro\": %.3f",
+           (double)estat->total_bytes / estat->quadros,
+           (double)estat->total_escritas / estat->quadros);
+  }
+  printf("}");
+  primeiro = false;
+}
+
+/**
+ * @brief Prepara uma partida com todas as palavras já caindo.
+ *
+ * @param p Partida.
+ * @param n Número de palavras.
+ */
+static void partida_ativa(Partida *p, int n)
+{
+  partida_ini(p, n, false);
+  for (int i = 0; i < p->reserva.n; i++) {
+    int vaga = p->reserva.ocupadas[i];
+    p->reserva.hora_ativacao[vaga] = 0;
+    agenda_marca(&p->agenda, vaga, 0);
+  }
+  Ocorrencias oc;
+  partida_passo(p, 0, NULL, NULL, 0, &oc);
+}
+
+/**
+ * @brief Faz as palavras que chegaram ao fim da queda recomeçarem do alto da tela.
+ *
+ * Assim nenhuma palavra expira e o número de palavras caindo não muda durante a medição.
+ *
+ * @param p Partida.
+ * @param hora Hora do próximo passo da partida.
+ */
+static void rearma_palavras(Partida *p, double hora)
+{
+  int vaga = agenda_primeira(&p->agenda);
+  while (vaga != -1 && agenda_prazo(&p->agenda, vaga) <= hora) {
+    p->reserva.hora_ativacao[vaga] = hora;
+    agenda_marca(&p->agenda, vaga, hora + p->reserva.tempo_digitacao[vaga]);
+    vaga = agenda_primeira(&p->agenda);
+  }
+}
+
+/**
+ * @brief Mede a carga do arquivo de palavras.
+ */
+static void mede_dicionario(void)
+{
+  int n = 200;
+  dicionario_fecha();
+  double inicio = tela_relogio();
+  for (int i = 0; i < n; i++) {
+    dicionario_abre("palavras", palavra_valida);
+    descarte += dicionario_tamanho();
+    dicionario_fecha();
+  }
+  double segundos = tela_relogio() - inicio;
+  dicionario_abre("palavras", palavra_valida);
+  resultado("dicionario_abre", 0, n, segundos, NULL);
+}
+
+/**
+ * @brief Mede o sorteio das palavras de uma partida.
+ *
+ * @param n_palavras Número de palavras sorteadas.
+ */
+static void mede_sorteio(int n_palavras)
+{
+  Reserva reserva;
+  reserva_ini(&reserva, n_palavras);
+  for (int i = 0; i < n_palavras; i++) {
+    reserva_pega(&reserva);
+  }
+  int n = REPETICOES / n_palavras;
+  double inicio = tela_relogio();
+  for (int i = 0; i < n; i++) {
+    preenche_palavras(&reserva);
+    descarte += reserva.letras[0][0];
+  }
+  double segundos = tela_relogio() - inicio;
+  reserva_fim(&reserva);
+  resultado("preenche_palavras", n_palavras, n, segundos, NULL);
+}
+
+/**
+ * @brief Mede a seleção de palavra pela primeira letra.
+ *
+ * Cada operação seleciona uma palavra e a devolve ao índice, para que o número de
+ * palavras disponíveis não mude.
+ *
+ * @param n_palavras Número de palavras em jogo.
+ */
+static void mede_selecao(int n_palavras)
+{
+  Partida p;
+  partida_ativa(&p, n_palavras);
+  double inicio = tela_relogio();
+  for (int i = 0; i < REPETICOES; i++) {
+    char letra = p.reserva.letras[p.reserva.ocupadas[i % p.reserva.n]][0];
+    int sel = seleciona_palavra(&p.indice, letra);
+    indice_insere(&p.indice, sel, letra);
+    descarte += sel;
+  }
+  double segundos = tela_relogio() - inicio;
+  partida_fim(&p);
+  resultado("seleciona_palavra", n_palavras, REPETICOES, segundos, NULL);
+}
+
+/**
+ * @brief Mede a verificação de expiração das palavras.
+ *
+ * @param n_palavras Número de palavras em jogo.
+ */
+static void mede_expiracao(int n_palavras)
+{
+  Partida p;
+  partida_ativa(&p, n_palavras);
+  double inicio = tela_relogio();
+  for (int i = 0; i < REPETICOES; i++) {
+    descarte += tempo_digitacao_expirou(&p);
+  }
+  double segundos = tela_relogio() - inicio;
+  partida_fim(&p);
+  resultado("tempo_digitacao_expirou", n_palavras, REPETICOES, segundos, NULL);
+}
+
+/**
+ * @brief Mede o desenho de quadros completos, com as palavras caindo.
+ *
+ * @param nlin Número de linhas da tela.
+ * @param ncol Número de colunas da tela.
+ * @param n_palavras Número de palavras em jogo.
+ */
+static void mede_desenho(int nlin, int ncol, int n_palavras)
+{
+  Partida p;
+  partida_ativa(&p, n_palavras);
+  // a partida não pode acabar pelo tempo total antes do último quadro
+  p.tempo_total = QUADROS / (double)FPS_PADRAO + 1;
+  tela_ini_memoria(nlin, ncol);
+  // o primeiro quadro desenha a tela toda e não entra na medição
+  desenha_tela(&p);
+  tela_estatisticas_t antes, depois;
+  tela_estatisticas(&antes);
+  double inicio = tela_relogio();
+  for (int i = 0; i < QUADROS; i++) {
+    // a hora só avança; as palavras que chegam ao fim da queda recomeçam do alto
+    double hora = (i + 1) / (double)FPS_PADRAO;
+    rearma_palavras(&p, hora);
+    Ocorrencias oc;
+    partida_passo(&p, hora, NULL, NULL, 0, &oc);
+    desenha_tela(&p);
+  }
+  double segundos = tela_relogio() - inicio;
+  tela_estatisticas(&depois);
+  tela_fim();
+  partida_fim(&p);
+
+  tela_estatisticas_t estat = {
+    .quadros = depois.quadros - antes.quadros,
+    .total_escritas = depois.total_escritas - antes.total_escritas,
+    .total_bytes = depois.total_bytes - antes.total_bytes,
+  };
+  char nome[64];
+  snprintf(nome, sizeof(nome), "desenha_tela/%dx%d", nlin, ncol);
+  resultado(nome, n_palavras, QUADROS, segundos, &estat);
+}
+
+/**
+ * @brief Grava recordes a partir de vários processos ao mesmo tempo.
+ *
+ * Os processos gravam pontuações diferentes em um diretório temporário, todos começando
+ * juntos. No final, os RECORDES_MAX recordes guardados devem ser exatamente as maiores
+ * pontuações gravadas.
+ *
+ * @return Número de recordes perdidos.
+ */
+static int mede_recordes_concorrentes(void)
+{
+  int total = PROCESSOS * RECORDES_POR_PROCESSO;
+  char dir[] = "/tmp/falling-words-XXXXXX";
+  int origem = open(".", O_RDONLY);
+  if (origem == -1 || mkdtemp(dir) == NULL || chdir(dir) != 0) {
+    perror("Erro ao criar o diretório dos recordes");
+    return total;
+  }
+
+  // os processos esperam o fechamento do cano para começar juntos
+  int cano[2];
+  if (pipe(cano) != 0) {
+    perror("Erro ao criar o cano");
+    return total;
+  }
+  for (int p = 0; p < PROCESSOS; p++) {
+    if (fork() == 0) {
+      close(cano[1]);
+      char c;
+      while (read(cano[0], &c, 1) > 0) {
+      }
+      bool ok = true;
+      for (int r = 0; r < RECORDES_POR_PROCESSO; r++) {
+        char nome[RECORDES_N_NOME];
+        snprintf(nome, sizeof(nome), "p%d r%d", p, r);
+        ok = recordes_acrescenta(nome, r * PROCESSOS + p) && ok;
+      }
+      _exit(ok ? 0 : 1);
+    }
+  }
+  close(cano[0]);
+  double inicio = tela_relogio();
+  close(cano[1]);
+  int falhas = 0;
+  int estado;
+  while (wait(&estado) > 0) {
+    if (!WIFEXITED(estado) || WEXITSTATUS(estado) != 0) {
+      falhas++;
+    }
+  }
+  double segundos = tela_relogio() - inicio;
+
+  // a pontuação total-1-i deve estar na posição i
+  Jogador jogadores[RECORDES_MAX];
+  int n = recordes_melhores(jogadores, RECORDES_MAX);
+  int esperados = total < RECORDES_MAX ? total : RECORDES_MAX;
+  int perdidos = esperados;
+  for (int i = 0; i < n && i < esperados; i++) {
+    int pontos = total - 1 - i;
+    char nome[RECORDES_N_NOME];
+    snprintf(nome, sizeof(nome), "p%d r%d", pontos % PROCESSOS, pontos / PROCESSOS);
+    if (jogadores[i].pontos == pontos && strcmp(jogadores[i].nome, nome) == 0) {
+      perdidos--;
+    }
+  }
+
+  unlink(RECORDES_ARQUIVO);
+  unlink(RECORDES_ARQUIVO ".tmp");
+  unlink(RECORDES_ARQUIVO ".trava");
+  if (fchdir(origem) != 0 || rmdir(dir) != 0) {
+    perror("Erro ao remover o diretório dos recordes");
+  }
+  close(origem);
+
+  printf("%s\n    {\"nome\": \"recordes_acrescenta/concorrente\", \"processos\": %d, "
+         "\"iteracoes\": %d, \"ns_por_op\": %.1f, \"falhas\": %d, \"perdidos\": %d}",
+         primeiro ? "" : ",", PROCESSOS, total, segundos * 1e9 / total, falhas, perdidos);
+  primeiro = false;
+  return perdidos + falhas;
+}
+
+int main(void)
+{
+  srand(1);
+  if (!dicionario_abre("palavras", palavra_valida)) {
+    perror("Erro ao abrir o arquivo");
+    return 1;
+  }
+  if (dicionario_tamanho() < quantidades[N_QUANTIDADES - 1]) {
+    fprintf(stderr, "O arquivo de palavras tem menos de %d palavras válidas\n",
+            quantidades[N_QUANTIDADES - 1]);
+    return 1;
+  }
+
+  printf("{\n  \"resultados\": [");
+  mede_dicionario();
+  for (int q = 0; q < N_QUANTIDADES; q++) {
+    mede_sorteio(quantidades[q]);
+  }
+  for (int q = 0; q < N_QUANTIDADES; q++) {
+    mede_selecao(quantidades[q]);
+  }
+  for (int q = 0; q < N_QUANTIDADES; q++) {
+    mede_expiracao(quantidades[q]);
+  }
+  for (int t = 0; t < N_TAMANHOS; t++) {
+    for (int q = 0; q < N_QUANTIDADES; q++) {
+      mede_desenho(tamanhos[t][0], tamanhos[t][1], quantidades[q]);
+    }
+  }
+  // a saída é esvaziada antes de os processos serem criados, para não ser repetida
+  fflush(stdout);
+  int perdidos = mede_recordes_concorrentes();
+  printf("\n  ]\n}\n");
+
+  dicionario_fecha();
+  return perdidos == 0 ? 0 : 1;
+}
@@ -0,0 +1,171 @@
+/**
+ * @file dicionario.c
+ *
+ * @brief Implementação das funções de acesso ao arquivo de palavras.
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#include "dicionario.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * @brief Posição de uma palavra dentro do arquivo mapeado.
+ */
+typedef struct {
+  int inicio;  /**< Deslocamento do primeiro caractere. */
+  int tam;     /**< Número de caracteres, sem o fim de linha. */
+} Linha;
+
+static const char *conteudo;   /**< Arquivo mapeado em memória. */
+static size_t tam_conteudo;    /**< Tamanho do arquivo. */
+static Linha *linhas;          /**< Índice das linhas válidas do arquivo. */
+static int n_linhas;           /**< Número de linhas válidas do arquivo. */
+static int *ordem;             /**< Permutação dos índices, usada nos sorteios. */
+static int n_sorteadas;        /**< Quantas posições de ordem já saíram na rodada atual. */
+
+/**
+ * @brief Abre o arquivo de palavras e monta o índice das linhas.
+ *
+ * @param nome Nome do arquivo, com uma palavra por linha.
+ * @param valida Função que diz se uma palavra pode ser usada.
+ * @return Retorna true se o arquivo foi aberto, false caso contrário.
+ */
+bool dicionario_abre(const char *nome, bool (*valida)(const char *palavra, int tam))
+{
+  int fd = open(nome, O_RDONLY);
+  if (fd == -1) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) == -1 || st.st_size == 0) {
+    close(fd);
+    return false;
+  }
+  tam_conteudo = st.st_size;
+  void *m = mmap(NULL, tam_conteudo, PROT_READ, MAP_PRIVATE, fd, 0);
+  // o mapeamento continua válido depois de fechar o arquivo
+  close(fd);
+  if (m == MAP_FAILED) {
+    return false;
+  }
+  conteudo = m;
+
+  // conta as linhas para saber o tamanho do índice
+  int n = 0;
+  for (size_t i = 0; i < tam_conteudo; i++) {
+    if (conteudo[i] == '\n') {
+      n++;
+    }
+  }
+  if (conteudo[tam_conteudo - 1] != '\n') {
+    n++; // última linha sem '\n'
+  }
+  linhas = malloc(n * sizeof(Linha));
+  ordem = malloc(n * sizeof(int));
+  if (linhas == NULL || ordem == NULL) {
+    dicionario_fecha();
+    return false;
+  }
+
+  n_linhas = 0;
+  size_t inicio = 0;
+  for (size_t i = 0; i <= tam_conteudo; i++) {
+    if (i == tam_conteudo || conteudo[i] == '\n') {
+      if (i == tam_conteudo && i == inicio) {
+        break;
+      }
+      int tam = i - inicio;
+      if (tam > 0 && conteudo[i - 1] == '\r') {
+        tam--;
+      }
+      if (valida(conteudo + inicio, tam)) {
+        linhas[n_linhas].inicio = inicio;
+        linhas[n_linhas].tam = tam;
+        ordem[n_linhas] = n_linhas;
+        n_linhas++;
+        n_sorteadas = 0;
+      }
+      inicio = i + 1;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Libera o mapeamento do arquivo e o índice.
+ */
+void dicionario_fecha(void)
+{
+  if (conteudo != NULL) {
+    munmap((void *)conteudo, tam_conteudo);
+  }
+  free(linhas);
+  free(ordem);
+  conteudo = NULL;
+  linhas = NULL;
+  ordem = NULL;
+  tam_conteudo = 0;
+  n_linhas = 0;
+  n_sorteadas = 0;
+}
+
+/**
+ * @brief Retorna o número de palavras válidas do arquivo.
+ *
+ * @return Número de palavras.
+ */
+int dicionario_tamanho(void)
+{
+  return n_linhas;
+}
+
+/**
+ * @brief Retorna uma palavra do arquivo.
+ *
+ * @param i Índice da palavra, entre 0 e dicionario_tamanho()-1.
+ * @param tam Onde colocar o tamanho da palavra.
+ * @return Ponteiro para o início da palavra.
+ */
+const char *dicionario_palavra(int i, int *tam)
+{
+  *tam = linhas[i].tam;
+  return conteudo + linhas[i].inicio;
+}
+
+/**
+ * @brief Sorteia palavras diferentes do dicionário.
+ *
+ * Os k elementos da permutação depois dos já sorteados são trocados por
+ * elementos sorteados entre os restantes. A permutação continua válida
+ * depois do sorteio, então pode ser reaproveitada no próximo sem ser refeita.
+ *
+ * @param indices Onde colocar os índices sorteados.
+ * @param k Quantos índices sortear.
+ * @return Número de índices sorteados.
+ */
+int dicionario_sorteia(int *indices, int k)
+{
+  if (k > n_linhas) {
+    k = n_linhas;
+  }
+  // começa nova rodada se as restantes não bastam
+  if (n_sorteadas + k > n_linhas) {
+    n_sorteadas = 0;
+  }
+  for (int i = 0; i < k; i++) {
+    int s = n_sorteadas++;
+    int j = s + rand() % (n_linhas - s);
+    int aux = ordem[s];
+    ordem[s] = ordem[j];
+    ordem[j] = aux;
+    indices[i] = ordem[s];
+  }
+  return k;
+}
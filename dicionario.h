@@ -0,0 +1,67 @@
+/**
+ * @file dicionario.h
+ *
+ * @brief Definição das funções de acesso ao arquivo de palavras.
+ *
+ * O arquivo é mapeado em memória uma única vez, no início do programa, e
+ * é feito um índice com o início e o tamanho de cada linha válida. Depois
+ * disso, pegar uma palavra não faz nenhum acesso a arquivo.
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#ifndef DICIONARIO_H
+#define DICIONARIO_H
+
+#include <stdbool.h>
+
+/**
+ * @brief Abre o arquivo de palavras e monta o índice das linhas.
+ *
+ * Somente as linhas aceitas pela função de validação entram no índice.
+ *
+ * @param nome Nome do arquivo, com uma palavra por linha.
+ * @param valida Função que diz se uma palavra (de tamanho tam, sem '\0') pode ser usada.
+ * @return Retorna true se o arquivo foi aberto, false caso contrário.
+ */
+bool dicionario_abre(const char *nome, bool (*valida)(const char *palavra, int tam));
+
+/**
+ * @brief Libera o mapeamento do arquivo e o índice.
+ */
+void dicionario_fecha(void);
+
+/**
+ * @brief Retorna o número de palavras válidas do arquivo.
+ *
+ * @return Número de palavras.
+ */
+int dicionario_tamanho(void);
+
+/**
+ * @brief Retorna uma palavra do arquivo.
+ *
+ * A palavra não termina com '\0'; seu tamanho é colocado em *tam.
+ *
+ * @param i Índice da palavra, entre 0 e dicionario_tamanho()-1.
+ * @param tam Onde colocar o tamanho da palavra.
+ * @return Ponteiro para o início da palavra.
+ */
+const char *dicionario_palavra(int i, int *tam);
+
+/**
+ * @brief Sorteia palavras diferentes do dicionário.
+ *
+ * Usa um embaralhamento de Fisher-Yates parcial, sem repetir sorteios:
+ * o custo é proporcional a k, e não ao tamanho do dicionário. Sorteios
+ * seguidos continuam o mesmo embaralhamento, então uma palavra só se
+ * repete depois de todas as outras terem saído (a não ser que um sorteio
+ * de k palavras não caiba no que falta e o embaralhamento recomece).
+ *
+ * @param indices Onde colocar os índices sorteados.
+ * @param k Quantos índices sortear.
+ * @return Número de índices sorteados (menor que k se o dicionário for menor).
+ */
+int dicionario_sorteia(int *indices, int k);
+
+#endif /* DICIONARIO_H */
@@ -0,0 +1,174 @@
+/**
+ * @file entrada.c
+ *
+ * @brief Implementação da leitura de teclas em uma thread separada.
+ *
+ * O anel guarda dois contadores que só crescem: fim, escrito só pela thread de
+ * leitura, e inicio, escrito só pelo laço do jogo. Cada um publica com release
+ * o que escreveu antes e lê o outro com acquire; a tecla de número i fica na
+ * posição i % ENTRADA_CAPACIDADE.
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#include "entrada.h"
+#include "tecla.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+/**
+ * @brief Tecla lida, com sua hora de chegada.
+ */
+typedef struct {
+  char tecla;   /**< Tecla. */
+  double hora;  /**< Hora de chegada (relógio monotônico, em segundos). */
+} TeclaLida;
+
+// os contadores ficam em linhas de cache separadas, para que cada thread só
+//   escreva na sua
+static struct {
+  TeclaLida teclas[ENTRADA_CAPACIDADE];
+  _Alignas(64) atomic_uint inicio;
+  _Alignas(64) atomic_uint fim;
+} anel;
+
+static pthread_t leitora;
+static atomic_bool fechada; // o teclado foi fechado e a thread terminou
+static int fd_teclas = -1; // avisa o laço do jogo que há teclas
+static int fd_parada = -1; // avisa a thread de leitura que deve parar
+
+// coloca uma tecla no anel; retorna false (e a tecla se perde) se ele está cheio
+static bool coloca(char tecla, double hora)
+{
+  unsigned fim = atomic_load_explicit(&anel.fim, memory_order_relaxed);
+  unsigned inicio = atomic_load_explicit(&anel.inicio, memory_order_acquire);
+  if (fim - inicio == ENTRADA_CAPACIDADE) {
+    return false;
+  }
+  anel.teclas[fim % ENTRADA_CAPACIDADE] = (TeclaLida){ tecla, hora };
+  atomic_store_explicit(&anel.fim, fim + 1, memory_order_release);
+  return true;
+}
+
+// acorda quem espera em poll por um dos eventfd
+static void avisa(int fd)
+{
+  uint64_t um = 1;
+  while (write(fd, &um, sizeof(um)) < 0 && errno == EINTR) {
+  }
+}
+
+// laço da thread de leitura: dorme até chegar tecla, o pedido de parada ou o
+//   fechamento do teclado
+static void *le_teclas(void *arg)
+{
+  (void)arg;
+  struct pollfd fds[2] = {
+    { .fd = tecla_descritor(), .events = POLLIN },
+    { .fd = fd_parada,         .events = POLLIN },
+  };
+  for (;;) {
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    if (fds[1].revents != 0) {
+      break;
+    }
+    if (fds[0].revents != 0) {
+      // uma leitura traz todas as teclas que chegaram, com a mesma hora;
+      //   com o terminal desligado (POLLHUP) ou em erro, ela não traz nada
+      char teclas[TECLA_N_BYTES];
+      int n = tecla_le_teclas(teclas, TECLA_N_BYTES);
+      if (n < 0) {
+        // o teclado foi fechado: o laço do jogo é acordado para acabar
+        atomic_store_explicit(&fechada, true, memory_order_release);
+        avisa(fd_teclas);
+        break;
+      }
+      double hora = tecla_hora();
+      int colocadas = 0;
+      for (int i = 0; i < n; i++) {
+        colocadas += coloca(teclas[i], hora);
+      }
+      if (colocadas > 0) {
+        avisa(fd_teclas);
+      }
+    }
+  }
+  return NULL;
+}
+
+void entrada_ini(void)
+{
+  atomic_store(&anel.inicio, 0);
+  atomic_store(&anel.fim, 0);
+  atomic_store(&fechada, false);
+  fd_teclas = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  fd_parada = eventfd(0, EFD_CLOEXEC);
+  if (fd_teclas == -1 || fd_parada == -1) {
+    perror("Erro ao criar eventfd");
+    exit(1);
+  }
+  if (pthread_create(&leitora, NULL, le_teclas, NULL) != 0) {
+    fprintf(stderr, "Erro ao criar a thread de leitura do teclado\n");
+    exit(1);
+  }
+}
+
+void entrada_fim(void)
+{
+  if (fd_parada == -1) {
+    return;
+  }
+  avisa(fd_parada);
+  pthread_join(leitora, NULL);
+  close(fd_parada);
+  close(fd_teclas);
+  fd_parada = -1;
+  fd_teclas = -1;
+}
+
+int entrada_descritor(void)
+{
+  return fd_teclas;
+}
+
+bool entrada_fechada(void)
+{
+  return atomic_load_explicit(&fechada, memory_order_acquire);
+}
+
+int entrada_retira(char *teclas, double *horas, int max)
+{
+  // zera o aviso antes de olhar o anel: uma tecla colocada depois disso
+  //   avisa de novo
+  uint64_t n_avisos;
+  read(fd_teclas, &n_avisos, sizeof(n_avisos)); // falha se não havia aviso
+  unsigned inicio = atomic_load_explicit(&anel.inicio, memory_order_relaxed);
+  unsigned fim = atomic_load_explicit(&anel.fim, memory_order_acquire);
+  int n = 0;
+  while (inicio != fim && n < max) {
+    TeclaLida *t = &anel.teclas[inicio % ENTRADA_CAPACIDADE];
+    teclas[n] = t->tecla;
+    horas[n] = t->hora;
+    n++;
+    inicio++;
+  }
+  atomic_store_explicit(&anel.inicio, inicio, memory_order_release);
+  if (inicio != fim) {
+    avisa(fd_teclas); // sobraram teclas
+  }
+  return n;
+}
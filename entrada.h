@@ -0,0 +1,64 @@
+/**
+ * @file entrada.h
+ *
+ * @brief Definição da leitura de teclas em uma thread separada.
+ *
+ * Durante a partida, uma thread só lê o teclado: marca a hora de chegada de
+ * cada tecla e a coloca num anel de tamanho fixo, de onde o laço do jogo a
+ * retira. O anel tem um só produtor e um só consumidor e não usa travas, então
+ * um quadro demorado não atrasa a leitura nem a hora das teclas. A cada tecla
+ * colocada, um eventfd acorda o laço do jogo.
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#ifndef ENTRADA_H
+#define ENTRADA_H
+
+#include <stdbool.h>
+
+#define ENTRADA_CAPACIDADE 256 /**< Teclas no anel (potência de 2). */
+
+/**
+ * @brief Inicia a thread de leitura do teclado.
+ *
+ * Enquanto a thread estiver rodando, ninguém mais deve ler o teclado.
+ */
+void entrada_ini(void);
+
+/**
+ * @brief Para a thread de leitura e libera seus recursos.
+ *
+ * As teclas ainda não retiradas são descartadas.
+ */
+void entrada_fim(void);
+
+/**
+ * @brief Retorna o descritor que fica pronto para leitura quando há teclas no anel.
+ *
+ * @return Descritor (eventfd) para esperar com poll.
+ */
+int entrada_descritor(void);
+
+/**
+ * @brief Diz se o teclado foi fechado (fim do arquivo ou terminal desligado).
+ *
+ * Quando isso acontece, a thread de leitura termina e o descritor de entrada_descritor
+ * fica pronto, para acordar quem espera por teclas. As teclas que já estavam no anel
+ * ainda podem ser retiradas.
+ *
+ * @return true se nenhuma tecla vai mais chegar.
+ */
+bool entrada_fechada(void);
+
+/**
+ * @brief Retira as teclas que estão no anel, na ordem em que chegaram.
+ *
+ * @param teclas Onde colocar as teclas.
+ * @param horas Onde colocar a hora de chegada de cada tecla (relógio monotônico, em segundos).
+ * @param max Número máximo de teclas a retirar; as que sobrarem ficam para a próxima vez.
+ * @return Número de teclas retiradas.
+ */
+int entrada_retira(char *teclas, double *horas, int max);
+
+#endif /* ENTRADA_H */
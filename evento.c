@@ -0,0 +1,104 @@
+/**
+ * @file evento.c
+ *
+ * @brief Implementação das funções de espera por eventos do jogo.
+ *
+ * O laço do jogo dorme em poll até chegar uma tecla ou até o temporizador
+ * (timerfd) indicar que está na hora do próximo quadro.
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#include "evento.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+static int fd_tecla = -1;
+static int fd_quadro = -1;
+
+/**
+ * @brief Cria um temporizador que dispara fps vezes por segundo.
+ *
+ * @param fps Número de disparos por segundo.
+ * @return Descritor do temporizador.
+ */
+int evento_temporizador(int fps)
+{
+  int fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+  if (fd == -1) {
+    perror("Erro ao criar o temporizador");
+    exit(1);
+  }
+  if (fps < 1) {
+    fps = 1;
+  }
+  long periodo = 1000000000L / fps;
+  struct itimerspec t;
+  t.it_interval.tv_sec = periodo / 1000000000L;
+  t.it_interval.tv_nsec = periodo % 1000000000L;
+  t.it_value = t.it_interval;
+  timerfd_settime(fd, 0, &t, NULL);
+  return fd;
+}
+
+/**
+ * @brief Cria o temporizador de quadros e guarda o descritor do teclado.
+ *
+ * @param fd_teclado Descritor de onde são lidas as teclas.
+ * @param fps Número de quadros por segundo desejado.
+ */
+void evento_ini(int fd_teclado, int fps)
+{
+  fd_tecla = fd_teclado;
+  fd_quadro = evento_temporizador(fps);
+}
+
+/**
+ * @brief Fecha o temporizador de quadros.
+ */
+void evento_fim(void)
+{
+  if (fd_quadro != -1) {
+    close(fd_quadro);
+  }
+  fd_quadro = -1;
+  fd_tecla = -1;
+}
+
+/**
+ * @brief Espera até haver tecla para ler ou dar a hora de um novo quadro.
+ *
+ * @return Combinação de EVENTO_TECLA e EVENTO_QUADRO.
+ */
+int evento_espera(void)
+{
+  struct pollfd fds[2] = {
+    { .fd = fd_tecla,  .events = POLLIN },
+    { .fd = fd_quadro, .events = POLLIN },
+  };
+  while (poll(fds, 2, -1) < 0) {
+    if (errno != EINTR) {
+      return 0;
+    }
+  }
+
+  int eventos = 0;
+  if (fds[0].revents & (POLLIN | POLLHUP)) {
+    eventos |= EVENTO_TECLA;
+  }
+  if (fds[1].revents & POLLIN) {
+    // quantos períodos passaram desde a última leitura; quadros atrasados
+    // são desenhados uma vez só
+    uint64_t n;
+    if (read(fd_quadro, &n, sizeof(n)) == sizeof(n)) {
+      eventos |= EVENTO_QUADRO;
+    }
+  }
+  return eventos;
+}
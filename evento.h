@@ -0,0 +1,46 @@
+/**
+ * @file evento.h
+ *
+ * @brief Definição das funções de espera por eventos do jogo.
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#ifndef EVENTO_H
+#define EVENTO_H
+
+#define EVENTO_TECLA  1 /**< Há tecla para ser lida. */
+#define EVENTO_QUADRO 2 /**< Chegou a hora de desenhar um novo quadro. */
+
+/**
+ * @brief Cria um temporizador (timerfd) que dispara fps vezes por segundo.
+ *
+ * O descritor fica pronto para leitura a cada disparo; a leitura retorna quantos disparos
+ * aconteceram desde a leitura anterior.
+ *
+ * @param fps Número de disparos por segundo.
+ * @return Descritor do temporizador.
+ */
+int evento_temporizador(int fps);
+
+/**
+ * @brief Prepara a espera por eventos.
+ *
+ * @param fd_teclado Descritor de onde são lidas as teclas.
+ * @param fps Número de quadros por segundo desejado.
+ */
+void evento_ini(int fd_teclado, int fps);
+
+/**
+ * @brief Libera os recursos usados na espera por eventos.
+ */
+void evento_fim(void);
+
+/**
+ * @brief Espera, sem ocupar o processador, até acontecer algum evento.
+ *
+ * @return Combinação de EVENTO_TECLA e EVENTO_QUADRO.
+ */
+int evento_espera(void);
+
+#endif /* EVENTO_H */
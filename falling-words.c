@@ -8,11 +8,117 @@
  *
  * @author Luiz Felipe Cavalheiro
  *
- * @note Para rodar o jogo, digite: gcc falling-words.c funcoes.c tela.c tecla.c -o falling-words -lm && ./falling-words
+ * @note Para rodar o jogo, digite: gcc falling-words.c funcoes.c latencia.c sessao.c recordes.c regras.c simulacao.c servidor.c entrada.c ritmo.c tela.c tecla.c evento.c relogio.c dicionario.c indice.c agenda.c reserva.c -o falling-words -lm -pthread && ./falling-words
  *       ou então para jogar em ambiente Linux digite: 'make run clean' no mingw32 digite: 'mingw32-make run clean'
  */
 
 #include "funcoes.h"
+#include "simulacao.h"
+#include "servidor.h"
+
+/**
+ * @brief Lê as opções da linha de comando.
+ *
+ * Opções aceitas:
+ *   --fps N        quadros por segundo durante a partida (padrão FPS_PADRAO)
+ *   --palavras N   número de palavras de cada partida (padrão N_PALAVRAS)
+ *   --infinito     as palavras não param de surgir, cada vez mais rápido,
+ *                  até o tempo de uma delas acabar
+ *   --headless     simula partidas sem tela nem teclado e mostra quantos
+ *                  tiques por segundo as regras do jogo executam
+ *   --partidas N   número de partidas simuladas (padrão 1)
+ *   --roteiro ARQ  teclas digitadas nas partidas simuladas, repetidas em
+ *                  ciclo; sem roteiro, um jogador simulado digita
+ *   --grava ARQ    grava a sessão (semente e teclas) no arquivo ARQ
+ *   --repete ARQ   repete as partidas da sessão gravada em ARQ, sem tela, e
+ *                  mostra seus resultados
+ *   --rapido       repete a sessão o mais rápido possível, em vez de no
+ *                  tempo real
+ *   --servidor ARQ executa o servidor de partidas, esperando jogadores no
+ *                  socket Unix ARQ (as outras opções valem para as partidas)
+ *   --cliente ARQ  joga no servidor de partidas do socket ARQ
+ *   --carga ARQ    abre várias sessões no servidor do socket ARQ, digitando
+ *                  teclas ao acaso, e mede as respostas
+ *   --sessoes N    número de sessões abertas por --carga (padrão SESSOES_PADRAO)
+ *   --duracao N    segundos de execução de --carga (padrão DURACAO_PADRAO)
+ *   --latencia     ao sair, mostra o histograma da latência entre a leitura
+ *                  de cada tecla e o quadro que mostra seu efeito
+ *
+ * @param argc Número de argumentos.
+ * @param argv Argumentos.
+ * @param opcoes Opções a preencher.
+ * @return Retorna true se as opções são válidas, false caso contrário.
+ */
+static bool le_opcoes(int argc, char *argv[], Opcoes *opcoes)
+{
+  opcoes->fps = FPS_PADRAO;
+  opcoes->n_palavras = N_PALAVRAS;
+  opcoes->infinito = false;
+  opcoes->headless = false;
+  opcoes->partidas = 1;
+  opcoes->roteiro = NULL;
+  opcoes->latencia = false;
+  opcoes->grava = NULL;
+  opcoes->repete = NULL;
+  opcoes->rapido = false;
+  opcoes->servidor = NULL;
+  opcoes->cliente = NULL;
+  opcoes->carga = NULL;
+  opcoes->sessoes = SESSOES_PADRAO;
+  opcoes->duracao = DURACAO_PADRAO;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+      opcoes->fps = atoi(argv[++i]);
+      if (opcoes->fps < 1) {
+        return false;
+      }
+    } else if (strcmp(argv[i], "--infinito") == 0) {
+      opcoes->infinito = true;
+    } else if (strcmp(argv[i], "--palavras") == 0 && i + 1 < argc) {
+      opcoes->n_palavras = atoi(argv[++i]);
+      if (opcoes->n_palavras < 1) {
+        return false;
+      }
+    } else if (strcmp(argv[i], "--grava") == 0 && i + 1 < argc) {
+      opcoes->grava = argv[++i];
+    } else if (strcmp(argv[i], "--repete") == 0 && i + 1 < argc) {
+      opcoes->repete = argv[++i];
+    } else if (strcmp(argv[i], "--rapido") == 0) {
+      opcoes->rapido = true;
+    } else if (strcmp(argv[i], "--servidor") == 0 && i + 1 < argc) {
+      opcoes->servidor = argv[++i];
+    } else if (strcmp(argv[i], "--cliente") == 0 && i + 1 < argc) {
+      opcoes->cliente = argv[++i];
+    } else if (strcmp(argv[i], "--carga") == 0 && i + 1 < argc) {
+      opcoes->carga = argv[++i];
+    } else if (strcmp(argv[i], "--sessoes") == 0 && i + 1 < argc) {
+      opcoes->sessoes = atoi(argv[++i]);
+      if (opcoes->sessoes < 1) {
+        return false;
+      }
+    } else if (strcmp(argv[i], "--duracao") == 0 && i + 1 < argc) {
+      opcoes->duracao = atoi(argv[++i]);
+      if (opcoes->duracao < 1) {
+        return false;
+      }
+    } else if (strcmp(argv[i], "--latencia") == 0) {
+      opcoes->latencia = true;
+    } else if (strcmp(argv[i], "--headless") == 0) {
+      opcoes->headless = true;
+    } else if (strcmp(argv[i], "--partidas") == 0 && i + 1 < argc) {
+      opcoes->partidas = atoi(argv[++i]);
+      if (opcoes->partidas < 1) {
+        return false;
+      }
+    } else if (strcmp(argv[i], "--roteiro") == 0 && i + 1 < argc) {
+      opcoes->roteiro = argv[++i];
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
 
 /**
  * @brief Função principal do programa.
@@ -21,29 +127,105 @@
  * e executa o jogo. Apresenta a tela inicial e, enquanto o jogador desejar jogar novamente,
  * reinicia o jogo.
  *
+ * @param argc Número de argumentos.
+ * @param argv Argumentos.
  * @return Retorna 0 se a execução for bem-sucedida.
  */
-int main()
+int main(int argc, char *argv[])
 {
-  // Inicializa o gerador de números aleatórios
-  srand(time(0));
+  Opcoes opcoes;
+  if (!le_opcoes(argc, argv, &opcoes)) {
+    fprintf(stderr, "uso: %s [--fps N] [--palavras N] [--infinito] [--latencia] [--grava ARQ]\n"
+                    "       %s --headless [--partidas N] [--roteiro ARQ]\n"
+                    "       %s --repete ARQ [--rapido]\n"
+                    "       %s --servidor ARQ [--fps N] [--palavras N] [--infinito]\n"
+                    "       %s --cliente ARQ\n"
+                    "       %s --carga ARQ [--sessoes N] [--duracao N]\n",
+            argv[0], argv[0], argv[0], argv[0], argv[0], argv[0]);
+    return 1;
+  }
+
+  // Inicializa o gerador de números aleatórios; a semente é gravada na
+  //   sessão, para que ela possa ser repetida
+  unsigned long semente = time(0);
+  srand(semente);
+
+  // Carrega as palavras do jogo
+  if (!dicionario_abre("palavras", palavra_valida)) {
+    perror("Erro ao abrir o arquivo");
+    return 1;
+  }
+
+  // Repetição de sessão gravada: as opções de jogo vêm da gravação
+  if (opcoes.repete != NULL) {
+    bool ok = repete(&opcoes);
+    dicionario_fecha();
+    return ok ? 0 : 1;
+  }
+
+  if (dicionario_tamanho() < opcoes.n_palavras) {
+    fprintf(stderr, "O arquivo de palavras tem menos de %d palavras válidas\n", opcoes.n_palavras);
+    return 1;
+  }
+
+  // Sem terminal: só as regras do jogo, com relógio virtual
+  if (opcoes.headless) {
+    bool ok = simula(&opcoes);
+    dicionario_fecha();
+    return ok ? 0 : 1;
+  }
+
+  // Servidor, cliente e gerador de carga não usam o resto do programa
+  if (opcoes.servidor != NULL || opcoes.cliente != NULL || opcoes.carga != NULL) {
+    bool ok = opcoes.servidor != NULL ? servidor(&opcoes)
+            : opcoes.cliente != NULL ? cliente(&opcoes)
+            : carga(&opcoes);
+    dicionario_fecha();
+    return ok ? 0 : 1;
+  }
+
+  Sessao gravacao;
+  if (opcoes.grava != NULL) {
+    CabecalhoSessao cab = {
+      .semente = semente,
+      .n_validas = dicionario_tamanho(),
+      .n_palavras = opcoes.n_palavras,
+      .infinito = opcoes.infinito,
+    };
+    if (!sessao_grava(&gravacao, opcoes.grava, &cab)) {
+      perror("Erro ao criar o arquivo da sessão");
+      return 1;
+    }
+  }
 
   // Inicializa a interface gráfica e de teclado
   tela_ini();
   tecla_ini();
 
+  // latências das teclas de todas as partidas
+  Latencias latencias;
+  latencia_zera(&latencias);
+
   do {
     // Apresenta a tela inicial
     apresentacao();
 
     // Executa o jogo
-    jogo();
+    jogo(&opcoes, &latencias, opcoes.grava != NULL ? &gravacao : NULL);
 
   } while (quer_jogar_de_novo());
 
   // Finaliza a interface de teclado e tela
   tecla_fim();
   tela_fim();
+  dicionario_fecha();
+  if (opcoes.grava != NULL) {
+    sessao_fecha(&gravacao);
+  }
+
+  if (opcoes.latencia) {
+    latencia_despeja(&latencias, stderr);
+  }
 
   return 0;
 }
@@ -12,45 +12,118 @@
  * @brief Executa uma partida do jogo de digitação.
  *
  * Esta função contém a lógica principal do jogo, incluindo a inicialização, processamento
- * da entrada do jogador, atualização da tela e encerramento.
+ * da entrada do jogador, atualização da tela e encerramento. Entre um evento e outro
+ * (tecla digitada ou hora de desenhar um quadro) o programa fica parado, sem usar o processador.
+ *
+ * @param opcoes Opções escolhidas na linha de comando.
+ * @param latencias Histograma onde são acumuladas as latências das teclas de todas as partidas.
+ * @param gravacao Sessão onde as teclas da partida são gravadas, ou NULL.
  */
-void jogo()
+void jogo(const Opcoes *opcoes, Latencias *latencias, Sessao *gravacao)
 {
-  int n_palavras = N_PALAVRAS;
-  int p_selecionada = -1;  
-  Palavra palavrass[N_PALAVRAS];
-  
-  preenche_palavras(palavrass);
-  preenche_pos_horizontal(palavrass);
-  preenche_hora_ativacao(palavrass);
-  preenche_tempo_digitacao(palavrass);
+  Partida partida;
+  partida_ini(&partida, opcoes->n_palavras, opcoes->infinito);
 
   Jogador jogadores[MAX_JOGADORES];
   int num_jogadores = 0;
   
   le_recordes(jogadores,&num_jogadores);
 
-  // quando o programa começou, para calcular o tempo restante
-  double inicio = tela_relogio();
-  double tempo_restante = TEMPO;
-  double tempo_ultima_letra = 0.0;
-  
-  // quantas letras já foram acertadas
-  int pontos = 0;
+  // relógio da partida, lido uma vez por volta do laço
+  Relogio relogio;
+  relogio_ini(&relogio);
+
+  // tempo entre a leitura de cada tecla e o quadro que mostra seu efeito
+  Latencias lat;
+  latencia_zera(&lat);
   
-  while (tempo_restante > 0 && n_palavras > 0 ) {
-    tempo_restante = TEMPO - (tela_relogio() - inicio);
-    if (tempo_digitacao_expirou(palavrass,inicio,n_palavras)) {
+  // as teclas são lidas por outra thread, que marca a hora de chegada de cada uma
+  entrada_ini();
+  evento_ini(entrada_descritor(), opcoes->fps);
+  Ocorrencias oc;
+  long hora;
+  // hora da última tecla, ou do último passo: uma tecla que chegou enquanto o
+  //   passo anterior acontecia é tratada como se tivesse chegado nele
+  long hora_tecla = 0;
+  // o desenho só é refeito quando alguma coisa visível mudou, e no ritmo
+  //   que o terminal aguenta; as regras avançam a cada disparo, sempre
+  double proxima_mudanca = 0.0;
+  bool sujo = true;
+  tela_estatisticas_t est;
+  tela_estatisticas(&est);
+  Ritmo ritmo;
+  ritmo_ini(&ritmo, opcoes->fps, tela_relogio(), est.total_bytes);
+  tela_nao_bloqueia(true);
+  do {
+    int eventos = evento_espera();
+    char teclas[ENTRADA_CAPACIDADE];
+    double chegadas[ENTRADA_CAPACIDADE];
+    int n_teclas = 0;
+    // o fechamento do teclado é visto antes da retirada, para que as últimas
+    //   teclas ainda entrem no passo
+    bool teclado_fechado = entrada_fechada();
+    if (eventos & EVENTO_TECLA) {
+      n_teclas = entrada_retira(teclas, chegadas, ENTRADA_CAPACIDADE);
+    }
+    // o tique vem depois da retirada, para que nenhuma tecla chegue depois do passo
+    relogio_tique(&relogio);
+    // as regras recebem as horas em µs inteiros, as mesmas que são gravadas na
+    //   sessão, para que a repetição tenha exatamente o mesmo resultado
+    hora = relogio_agora(&relogio) * 1e6;
+    // as regras não leem o teclado: as teclas são entregues ao passo, cada uma
+    //   com sua hora de chegada na partida
+    double horas[ENTRADA_CAPACIDADE];
+    for (int i = 0; i < n_teclas; i++) {
+      latencia_chegada(&lat, chegadas[i]);
+      long h = relogio_converte(&relogio, chegadas[i]) * 1e6;
+      if (h > hora_tecla) {
+        hora_tecla = h;
+      }
+      horas[i] = hora_tecla * 1e-6;
+      if (gravacao != NULL && teclas[i] != '\0') {
+        sessao_grava_tecla(gravacao, hora_tecla, teclas[i]);
+      }
+    }
+    partida_passo(&partida, hora * 1e-6, teclas, horas, n_teclas, &oc);
+    hora_tecla = hora;
+    if (oc.expirou || teclado_fechado) {
       break;
     }
-    processa_entrada(palavrass,&p_selecionada,&n_palavras,&pontos,inicio,&tempo_ultima_letra); 
-    desenha_tela(palavrass, n_palavras, p_selecionada, pontos, inicio);
+    sujo = sujo || oc.ativadas + oc.acertos + oc.erros + oc.completas > 0
+              || partida.agora >= proxima_mudanca
+              || tela_verifica_tamanho();
+    double inicio = tela_relogio();
+    if (sujo && ritmo_pode_desenhar(&ritmo, inicio)) {
+      proxima_mudanca = desenha_tela(&partida);
+      sujo = false;
+      tela_estatisticas(&est);
+      ritmo_desenhou(&ritmo, inicio, tela_relogio(), est.total_bytes, tela_atrasada());
+    } else if (tela_atrasada()) {
+      // tenta de novo enviar o que o terminal não aceitou
+      tela_atualiza();
+    }
+    // as teclas só aparecem quando o quadro chega ao terminal: nem com
+    //   desenho adiado pelo ritmo, nem com quadro ainda retido
+    if (!sujo && !tela_atrasada()) {
+      latencia_quadro(&lat, tela_relogio());
+    }
+  } while (!oc.fim);
+  // daqui em diante (encerramento, recordes) a saída volta a esperar o terminal
+  tela_nao_bloqueia(false);
+  evento_fim();
+  entrada_fim();
+  if (gravacao != NULL) {
+    sessao_grava_fim(gravacao, hora);
   }
+  int n_palavras = partida.reserva.n;
+  int pontos = partida.pontos;
+  partida_fim(&partida);
   
-  encerramento(n_palavras,pontos);
+  latencia_junta(latencias, &lat);
+  encerramento(n_palavras,pontos,&lat);
   
   if (pontuacao_top3(jogadores,num_jogadores,pontos)) {
-    atualiza_recordes(jogadores,num_jogadores,pontos);
+    atualiza_recordes(pontos);
   }
 
   mostra_recordes();
@@ -66,8 +139,8 @@ void espera_enter()
 {
   char l;
   do {
-    l = tecla_le_char();
-  } while (l != '\n'); 
+    l = tecla_espera_char(-1);
+  } while (l != '\n' && !tecla_fechada());
   tela_atualiza();
 }
 
@@ -85,44 +158,44 @@ void apresentacao()
   
   tela_lincol(lin, col);
   tela_cor_letra(0,240,0);
-  printf("+---------------------------------------------------------------------+");
+  tela_escreve("+---------------------------------------------------------------------+");
   tela_lincol(++lin, col);
-  printf("| ");
+  tela_escreve("| ");
   tela_lincol(lin,col+2);
   tela_cor_normal();
-  printf("Você deve digitar as palavras que aparecerão na tela");
+  tela_escreve("Você deve digitar as palavras que aparecerão na tela");
   tela_cor_letra(0,240,0);
   tela_lincol(lin,col+70);
-  printf("|");
+  tela_escreve("|");
   tela_lincol(++lin, col);
-  printf("| ");
+  tela_escreve("| ");
   tela_lincol(lin,col+2);
   tela_cor_normal();
-  printf("Você deve digitar a primeira letra de uma palavra para selecioná-la ");
+  tela_escreve("Você deve digitar a primeira letra de uma palavra para selecioná-la ");
   tela_cor_letra(0,240,0);
   tela_lincol(lin,col+70);
-  printf("|");
+  tela_escreve("|");
   tela_lincol(++lin, col);
-  printf("| ");
+  tela_escreve("| ");
   tela_lincol(lin,col+2);
   tela_cor_normal();
-  printf("Então ela aparecerá na parte de baixo da tela entre setas");
+  tela_escreve("Então ela aparecerá na parte de baixo da tela entre setas");
   tela_cor_letra(0,240,0);
   tela_lincol(lin,col+70);
-  printf("|");
+  tela_escreve("|");
   tela_lincol(++lin, col);
-  printf("| ");
+  tela_escreve("| ");
   tela_lincol(lin,col+2);
   tela_cor_normal();
-  printf("Quanto mais baixa a palavra estiver, menor o tempo para digitá-la   ");
+  tela_escreve("Quanto mais baixa a palavra estiver, menor o tempo para digitá-la   ");
   tela_cor_letra(0,240,0);
   tela_lincol(lin,col+70);
-  printf("|");
+  tela_escreve("|");
   tela_lincol(++lin, col);
-  printf("+---------------------------------------------------------------------+");
+  tela_escreve("+---------------------------------------------------------------------+");
   tela_lincol(++lin, tela_ncol() / 2 - 27 / 2);
   tela_cor_letra(250, 250, 30);
-  printf("Tecle <enter> para iniciar");
+  tela_escreve("Tecle <enter> para iniciar");
   tela_atualiza();
   espera_enter();
 }
@@ -130,39 +203,15 @@ void apresentacao()
 /**
  * @brief Lê os recordes do jogo e armazena jogador e pontuação.
  *
- * Esta função lê o arquivo "recordes.txt" que armazena os recordes do jogo, 
- * inicializa o vetor de jogadores e a quantidade total de jogadores.
+ * Os recordes vêm da memória, e o arquivo de recordes só é lido de novo quando muda.
+ * Preenche o vetor de jogadores com os MAX_JOGADORES melhores e a quantidade total de jogadores.
  *
  * @param jogadores Vetor de jogadores a ser preenchido.
  * @param num_jogadores Número total de jogadores (atualizado pela função).
  */
 void le_recordes(Jogador* jogadores, int *num_jogadores)
 {
-  FILE *arquivo;
-  arquivo = fopen("recordes.txt", "r");
-
-  if (arquivo == NULL) {
-    arquivo = fopen("recordes.txt", "w");
-    fclose(arquivo);
-    arquivo = fopen("recordes.txt", "r");
-  }
-  
-  char linha[100];
-  int tamanho_nome;
-  while (*num_jogadores < MAX_JOGADORES && fgets(linha, sizeof(linha), arquivo) != NULL) {
-    size_t length = strlen(linha);
-    if (linha[length - 1] == '\n') {
-      linha[length - 1] = '\0';
-    }
-
-    if (sscanf(linha, "%*d) %[^-] - %d pontos", jogadores[*num_jogadores].nome, &jogadores[*num_jogadores].pontos) == 2) {
-      tamanho_nome = strlen(jogadores[*num_jogadores].nome);
-      jogadores[*num_jogadores].nome[tamanho_nome-1] = '\0'; //para retirar o carcatere de espaço
-      (*num_jogadores)++;
-    }
-  }
-
-  fclose(arquivo);
+  *num_jogadores = recordes_melhores(jogadores, MAX_JOGADORES);
 }
 
 /**
@@ -173,8 +222,9 @@ void le_recordes(Jogador* jogadores, int *num_jogadores)
  *
  * @param n_palavra Número de palavras restantes.
  * @param pontos Pontuação total do jogador.
+ * @param latencias Latências das teclas da partida, mostradas junto com a pontuação.
  */
-void encerramento(int n_palavra, int pontos)
+void encerramento(int n_palavra, int pontos, const Latencias *latencias)
 {
   tela_limpa();
 
@@ -185,17 +235,24 @@ void encerramento(int n_palavra, int pontos)
 
   if (n_palavra <= 0) {
     tela_cor_letra(250, 250, 30);
-    printf("PARABÉNS!! VOCÊ VENCEU!!!");
+    tela_escreve("PARABÉNS!! VOCÊ VENCEU!!!");
     tela_lincol(++lin, col);
   } else {
     tela_cor_letra(230, 10, 10);
-    printf("FIM DE JOGO!!!");
+    tela_escreve("FIM DE JOGO!!!");
     tela_lincol(++lin, col);
   }
   
-  printf("TOTAL:  %d PONTOS",pontos);
+  tela_escreve("TOTAL:  %d PONTOS",pontos);
   tela_lincol(++lin, col);
-  printf("Tecle <enter> para seguir");
+  if (latencias->n > 0) {
+    tela_cor_normal();
+    tela_escreve("Latência: p50 %.1f ms, p99 %.1f ms, máx %.1f ms",
+                 latencia_percentil(latencias, 50) * 1e3, latencia_percentil(latencias, 99) * 1e3,
+                 latencia_max(latencias) * 1e3);
+    tela_lincol(++lin, col);
+  }
+  tela_escreve("Tecle <enter> para seguir");
 
   tela_atualiza();
   espera_enter();
@@ -217,517 +274,209 @@ bool quer_jogar_de_novo()
   int lin = tela_nlin() / 3;
   int col = tela_ncol() / 2 - 46/2;
   tela_lincol(lin,col);
-  printf("Digite 's' para jogar de novo ou 'n' para sair");
+  tela_escreve("Digite 's' para jogar de novo ou 'n' para sair");
   tela_lincol(lin+1,col);
-  printf(">: ");
+  tela_escreve(">: ");
   tela_atualiza();
   char c;
   while (true) {
-    c = tecla_le_char();
+    c = tecla_espera_char(-1);
     if (c == 's' || c == 'S') {
       return true;
-    } else if (c == 'n' || c == 'N') {
+    } else if (c == 'n' || c == 'N' || tecla_fechada()) {
       return false;
     }
   }
 }
 
 /**
- * @brief Preenche a matriz de palavras a serem usadas no jogo.
- *
- * Esta função lê palavras de um arquivo chamado "palavras" e preenche a matriz de palavras.
- * Cada palavra é lida aleatoriamente do arquivo, garantindo que não seja repetida.
- *
- * @param palavras Matriz de Palavra a ser preenchida.
- */
-void preenche_palavras(Palavra *palavras)
-{
-  int linha_atual = 1, qtde_palavras_add = 0;
-	int numeros_sorteados[N_PALAVRAS]; 
-	int num_sorteado, j=0;
-	char caractere;
-
-  for (int i = 0; i < N_PALAVRAS; i++) {
-    numeros_sorteados[i] = 0;
-  }
-
-	FILE *arquivo;
-  arquivo = fopen("palavras", "r");
-
-  if (arquivo == NULL) {
-    perror("Erro ao abrir o arquivo");
-    exit(1);
-  }
-
-	while(qtde_palavras_add < N_PALAVRAS) {
-		arquivo = fopen("palavras", "r");
-		
-		//numero sorteado nao pode estar no vetor
-		do {
-			num_sorteado = rand() % 920 + 1;
-		} while(numero_jah_sorteado(num_sorteado,numeros_sorteados));
-
-		// varre as linhas do arquivo até chegar na linha desejada
-		while(linha_atual < num_sorteado && (caractere = fgetc(arquivo)) != EOF) {
-			if (caractere == '\n')
-				linha_atual++;
-			if (linha_atual == num_sorteado)
-			  break;
-		}
-
-		// adiciona caracteres na matriz
-		do {
-			caractere = fgetc(arquivo);
-			if (caractere_valido(caractere)) {
-				caractere = converte_caractere(caractere);
-				palavras[qtde_palavras_add].palavra[j] = caractere;
-				j++;
-			} else {
-				break;
-			}
-		} while(caractere != '\n');
-
-		if (caractere == '\n') {
-			palavras[qtde_palavras_add].palavra[j] = '\0';
-			numeros_sorteados[qtde_palavras_add] = num_sorteado;
-			qtde_palavras_add++;
-		}
-
-		linha_atual = 1;
-		j = 0;
-	}
-	
-	fclose(arquivo);
-}
-
-/**
- * @brief Seleciona uma palavra com base na primeira letra e no tempo de ativação.
- *
- * @param palavras Array de palavras disponíveis.
- * @param n_palavras Número total de palavras.
- * @param l Primeira letra da palavra desejada.
- * @param inicio Tempo de início do jogo.
- * @return Retorna a posição da palavra selecionada no array ou -1 se nenhuma palavra for selecionada.
+ * @brief Posições da tela do jogo que só dependem do tamanho da tela.
  */
-int seleciona_palavra(Palavra *palavras, int n_palavras, char l, double inicio)
-{
-  int menor_tempo_ativacao = 0;
-  int pos = -1;
-  for (int i = 0; i < n_palavras; i++) {
-    if (palavras[i].palavra[0] == l && palavras[i].hora_ativacao <= tela_relogio() - inicio) {
-      if (menor_tempo_ativacao == 0) {
-        menor_tempo_ativacao = palavras[i].hora_ativacao;
-        pos = i;
-      } else if (palavras[i].hora_ativacao < menor_tempo_ativacao) {
-        menor_tempo_ativacao = palavras[i].hora_ativacao;
-        pos = i;
-      }
-    }
-  }
-  return pos;
-}
+typedef struct {
+  int nlin, ncol;       /**< Tamanho da tela para o qual as posições foram calculadas. */
+  int l_ini;            /**< Linha onde as palavras começam a cair. */
+  int alt;              /**< Número de linhas que as palavras percorrem. */
+  int col_pontuacao;    /**< Coluna da pontuação. */
+  int lin_regua;        /**< Linha da régua de baixo (a de cima fica na linha 2). */
+  int lin_selecionada;  /**< Linha da palavra selecionada. */
+  int col_selecionada;  /**< Coluna da palavra selecionada. */
+  char *regua;          /**< Régua com a largura da tela. */
+} Disposicao;
 
 /**
- * @brief Verifica se a letra fornecida é a primeira letra da palavra selecionada.
+ * @brief Libera as posições guardadas com uma tela.
  *
- * @param palavras Array de palavras.
- * @param p_sel Posição da palavra selecionada.
- * @param letra Letra fornecida.
- * @return Retorna true se a letra corresponder à primeira letra da palavra selecionada, false caso contrário.
+ * @param dados Posições (Disposicao) a liberar.
  */
-bool acha_letra(Palavra *palavras, int p_sel, char letra)
+static void libera_disposicao(void *dados)
 {
-  return palavras[p_sel].palavra[0] == letra;
+  Disposicao *d = dados;
+  free(d->regua);
+  free(d);
 }
 
 /**
- * @brief Remove a primeira letra da palavra selecionada.
+ * @brief Retorna as posições da tela do jogo, recalculando-as se o tamanho da tela mudou.
  *
- * @param palavras Array de palavras.
- * @param p_sel Posição da palavra selecionada.
- */
-void remove_pos(Palavra *palavras, int p_sel)
-{
-  int i = 0;
-  while (palavras[p_sel].palavra[i] != '\0') {
-    palavras[p_sel].palavra[i] = palavras[p_sel].palavra[i+1];
-    i++;
-  }
-}
-
-/**
- * @brief Remove a palavra selecionada do array de palavras.
+ * As posições ficam guardadas com cada tela (ver tela_guarda_dados), então telas de
+ * tamanhos diferentes, como as das sessões do servidor, não desfazem as contas umas das
+ * outras.
  *
- * @param palavras Array de palavras.
- * @param p_sel Posição da palavra selecionada.
+ * @return Posições para o tamanho atual da tela selecionada.
  */
-void remove_palavra(Palavra *palavras, int p_sel)
+static const Disposicao *dispoe_tela(void)
 {
-  Palavra aux;
-  int i;
-  for (i = p_sel; i < N_PALAVRAS; i++) {
-    if (i == p_sel) {
-      aux = palavras[i];
-    }
-    if (i+1 == N_LETRA) {
-      palavras[i] = aux;
-    } else {
-      palavras[i] = palavras[i+1];
+  Disposicao *d = tela_dados();
+  if (d == NULL) {
+    d = malloc(sizeof(Disposicao));
+    if (d == NULL) {
+      perror("Sem memória para a tela");
+      exit(1);
     }
+    *d = (Disposicao){ .nlin = -1, .ncol = -1 };
+    tela_guarda_dados(d, libera_disposicao);
   }
-}
-
-/**
- * @brief Verifica se a palavra selecionada foi completamente digitada.
- *
- * @param palavras Array de palavras.
- * @param p_sel Posição da palavra selecionada.
- * @return Retorna true se a palavra foi completamente digitada, false caso contrário.
- */
-bool palavra_selecionada_terminou(Palavra *palavras,int p_sel)
-{
-  if (p_sel != -1 && palavras[p_sel].palavra[0] == '\0') {
-    return true;
-  } else {
-    return false;   
+  if (d->nlin == tela_nlin() && d->ncol == tela_ncol()) {
+    return d;
   }
-}
-
-/**
- * @brief Verifica se o caractere fornecido é uma letra válida.
- *
- * Um caractere é válido se for de a-z ou A-Z sem acentos e/ou caracteres especiais.
- * 
- * @param l Caractere fornecido.
- * @return Retorna true se o caractere for uma letra válida, false caso contrário.
- */
-bool caractere_valido(char l)
-{
-	if((l >= 'A' && l <= 'Z') || (l >= 'a' && l <= 'z')) {
-		return true;
-	} else {
-		return false;
-  }
-}
-
-/**
- * @brief Converte um caractere para minúsculo, se for uma letra maiúscula.
- *
- * @param l Caractere fornecido.
- * @return Retorna o caractere convertido para minúsculo, se for uma letra maiúscula; caso contrário, retorna o caractere original.
- */
-char converte_caractere(char l)
-{
-	if (l >= 'A' && l <= 'Z') {
-		return l + 32;
-  } else {
-		return l;
-  }
-}
-
-/**
- * @brief Verifica se um número já foi sorteado.
- *
- * Cada palavra é representada por um numero, essa funcao serve para garantir que uma palavra não seja repetida.
- * 
- * @param num Número a ser verificado.
- * @param vet Vetor de números já sorteados.
- * @return Retorna true se o número já foi sorteado, false caso contrário.
- */
-bool numero_jah_sorteado(int num, int vet[N_PALAVRAS])
-{
-	for (int i = 0;  i < N_PALAVRAS; i++) {
-		if (vet[i] == num) {
-			return true;
-    }
-	}
-	return false;
-}
-
-/**
- * @brief Processa a entrada do jogador, atualizando o estado do jogo.
- *
- * @param palavras Array de palavras.
- * @param p_selecionada Posição da palavra selecionada.
- * @param n_palavras Número de palavras restantes.
- * @param pontos Pontuação do jogador.
- * @param inicio Tempo de início do jogo.
- * @param tempo_ultima_letra Tempo da última letra digitada.
- */
-void processa_entrada(Palavra *palavras, int *p_selecionada, int *n_palavras, int *pontos, double inicio, double *tempo_ultima_letra)
-{
-  //Se já terminou a palavra selecionada
-  if (*p_selecionada != -1 && palavra_selecionada_terminou(palavras,*p_selecionada) ) {
-    *n_palavras -= 1;
-    remove_palavra(palavras,*p_selecionada);
-    *p_selecionada = -1;
-  }
-
-  char letra;
-  letra = tecla_le_char();
-
-  if(*p_selecionada == -1){
-    *p_selecionada = seleciona_palavra(palavras,*n_palavras,letra,inicio);
+  d->nlin = tela_nlin();
+  d->ncol = tela_ncol();
+  d->l_ini = 4;
+  d->alt = d->nlin - 4;
+  d->col_pontuacao = d->ncol/2 - 20/2;
+  d->lin_regua = d->nlin - 1;
+  d->lin_selecionada = d->nlin;
+  d->col_selecionada = d->ncol/2 - 20/2;
+  char *regua = realloc(d->regua, d->ncol + 1);
+  if (regua == NULL) {
+    perror("Sem memória para a tela");
+    exit(1);
   }
-    
-  //se tem palavra selecionada e a letra esta correta, remove a letra
-  if (*p_selecionada != -1) {
-    if (acha_letra(palavras,*p_selecionada,letra)) {
-      remove_pos(palavras, *p_selecionada);
-      if (tela_relogio() - *tempo_ultima_letra >= 1) {
-        *pontos += 1;
-      } else {
-        *pontos += 100 * (1 - (tela_relogio() - *tempo_ultima_letra));
-      }
-      *tempo_ultima_letra = tela_relogio();
-      
-    } else if(letra != '\0') {  
-      if (*pontos - 10 < 0){
-        *pontos = 0;
-      } else {
-        *pontos -= 10; 
-      }
-      *tempo_ultima_letra = tela_relogio();
-    }    
-  } 
-}
-
-/**
- * @brief Preenche as posições horizontais das palavras no array.
- *
- * @param palavras Array de palavras.
- */
-void preenche_pos_horizontal(Palavra *palavras)
-{
-  for (int i = 0; i < N_PALAVRAS; i++) {
-    palavras[i].pos_horizontal = rand() % 101;
-  } 
-}
-
-/**
- * @brief Preenche as horas de ativação das palavras no array.
- *
- * @param palavras Array de palavras.
- */
-void preenche_hora_ativacao(Palavra *palavras)
-{
-  for (int i = 0; i < N_PALAVRAS; i++) {
-    palavras[i].hora_ativacao = rand() % (N_PALAVRAS * 2 + 1);
-  } 
-}
-
-/**
- * @brief Preenche os tempos de digitação das palavras no array.
- *
- * @param palavras Array de palavras.
- */
-void preenche_tempo_digitacao(Palavra *palavras)
-{
-  for (int i = 0; i < N_PALAVRAS; i++) {
-    palavras[i].tempo_digitacao = rand() % 26 + 5;
-  } 
+  memset(regua, '_', d->ncol);
+  regua[d->ncol] = '\0';
+  d->regua = regua;
+  return d;
 }
 
 /**
  * @brief Desenha a tela do jogo com as palavras, pontuação e informações relevantes.
  *
- * @param palavras Array de palavras.
- * @param n_palavra Número de palavras restantes.
- * @param p_selecionada Posição da palavra selecionada.
- * @param pontos Pontuação do jogador.
- * @param inicio Tempo de início do jogo.
+ * As palavras que estão caindo são as que estão no índice (ativadas e não selecionadas).
+ * Cada uma desce uma linha a cada tempo_digitacao / (nlin - 4) segundos, contados em
+ * segundos inteiros desde sua ativação; junto com o desenho é calculada a hora em que a
+ * próxima delas muda de linha.
+ *
+ * @param p Partida.
+ * @return Hora da partida em que alguma palavra muda de linha, ou HUGE_VAL se nenhuma muda.
  */
-void desenha_tela(Palavra *palavras, int n_palavra, int p_selecionada, int pontos, double inicio)
+double desenha_tela(const Partida *p)
 {
-  int i = 0, k = 0, lin = 0, col = 0, l_ini, alt, t_ativa;
+  int lin = 0, col = 0, t_ativa;
+  const Reserva *r = &p->reserva;
+  const IndiceLetras *indice = &p->indice;
+  int p_selecionada = p->selecionada;
+  double agora = p->agora;
+  double proxima_mudanca = HUGE_VAL;
   
   tela_limpa();
-  tela_lincol(lin,tela_ncol()/2 - 20/2);
-  printf("Pontuação: %d ",pontos);
+  const Disposicao *d = dispoe_tela();
+  int l_ini = d->l_ini, alt = d->alt;
+  tela_lincol(lin,d->col_pontuacao);
+  tela_escreve("Pontuação: %d ",p->pontos);
   tela_lincol(lin+=2,0);
-  while (k < tela_ncol()) {
-    printf("_");
-    k++;
-  }
-  k = 0;
+  tela_escreve("%s", d->regua);
 
   tela_cor_normal();
   
 
-  while (i < n_palavra) {
-    if (i != p_selecionada && palavras[i].hora_ativacao <= tela_relogio() - inicio) {
-      col = (tela_ncol() - tam_palavra(palavras[i].palavra)) * palavras[i].pos_horizontal / 100;
-      l_ini = 4;
-      alt = tela_nlin() - 4;
-      t_ativa = tela_relogio() - inicio - palavras[i].hora_ativacao;
-      lin = l_ini + alt * t_ativa / palavras[i].tempo_digitacao;
+  for (int l = 0; l < INDICE_N_LETRAS; l++) {
+    for (int i = indice->primeira[l]; i != -1; i = indice->prox[i]) {
+      col = (d->ncol - r->tam[i]) * r->pos_horizontal[i] / 100;
+      t_ativa = agora - r->hora_ativacao[i];
+      lin = l_ini + alt * t_ativa / r->tempo_digitacao[i];
       tela_lincol(lin,col);
-      int j = 0;
-      while (palavras[i].palavra[j] != '\0') {
-        printf("%c", palavras[i].palavra[j]);
-        j++;
-        tela_atualiza();
+      tela_escreve("%s", r->letras[i]);
+      if (alt > 0) {
+        // primeiro segundo inteiro em que alt * t / tempo_digitacao passa para a próxima linha
+        int desce = ((lin - l_ini + 1) * r->tempo_digitacao[i] + alt - 1) / alt;
+        if (desce <= t_ativa) {
+          desce = t_ativa + 1;
+        }
+        if (r->hora_ativacao[i] + desce < proxima_mudanca) {
+          proxima_mudanca = r->hora_ativacao[i] + desce;
+        }
       }
     }
-    i++;
   }
 
   if (p_selecionada != -1) {
-    col = tela_ncol()/2 - 20/2;
-    lin = tela_nlin();
+    col = d->col_selecionada;
+    lin = d->lin_selecionada;
     tela_lincol(lin,col);
     tela_cor_letra(250, 250, 30);
-    int j = 0;
-    printf(">>>>> ");
+    tela_escreve(">>>>> ");
     tela_lincol(lin,col+=7);
-    while (palavras[p_selecionada].palavra[j] != '\0'){
-      printf("%c", palavras[p_selecionada].palavra[j]);
-      j++;
-    }
-    printf(" <<<<<");
+    // só as letras que faltam digitar
+    tela_escreve("%s", r->letras[p_selecionada] + r->digitadas[p_selecionada]);
+    tela_escreve(" <<<<<");
   }
 
-  tela_lincol(tela_nlin()-1,0);
-  while (k < tela_ncol()) {
-    printf("_");
-    k++;
-  }
+  tela_lincol(d->lin_regua,0);
+  tela_escreve("%s", d->regua);
 
   tela_atualiza();
 
+  return proxima_mudanca;
 }
 
 /**
- * @brief Calcula o tamanho de uma palavra.
+ * @brief Acrescenta a pontuação do jogador aos recordes.
  *
- * @param palavra Palavra fornecida.
- * @return Retorna o tamanho da palavra.
- */
-int tam_palavra(char palavra[N_LETRA])
-{
-  int i = 0;
-  while(palavra[i] != '\0'){
-    i++;
-  }
-  return i--;
-}
-
-/**
- * @brief Verifica se o tempo de digitação de alguma palavra expirou.
- *
- * @param palavras Array de palavras.
- * @param inicio Tempo de início do jogo.
- * @param n_palavra Número de palavras restantes.
- * @return Retorna true se o tempo de digitação de alguma palavra expirou, false caso contrário.
- */
-bool tempo_digitacao_expirou(Palavra *palavras, double inicio, int n_palavra)
-{
-  for (int i = 0;  i < n_palavra; i++) {
-    if (tela_relogio() - inicio >= palavras[i].hora_ativacao &&  tela_relogio() - inicio > palavras[i].hora_ativacao + palavras[i].tempo_digitacao) {
-        return true;
-    }
-  }
-  return false;
-}
-
-/**
- * @brief Atualiza o arquivo de recordes com a pontuação do jogador, se for uma das três melhores.
+ * Nada é gravado antes que o jogador termine de digitar o nome; interromper o programa
+ * nesse momento não altera os recordes.
  *
- * @param jogadores Array de jogadores.
- * @param num_jogadores Número de jogadores no array.
  * @param pontos Pontuação do jogador.
  */
-void atualiza_recordes(Jogador* jogadores, int num_jogadores, int pontos)
+void atualiza_recordes(int pontos)
 {
-
-  FILE *arquivo;
-  arquivo = fopen("recordes.txt","w");
-
-  if (arquivo == NULL) {
-    return;
-  }
-
   tela_limpa();
   int lin = tela_nlin() / 3;
   int col = tela_ncol() / 2 - 40 / 2;
   tela_lincol(lin,col);
   tela_cor_letra(0,240,0); 
-  printf("VOCÊ VAI ENTRAR PRA HISTÓRIA!!!");
+  tela_escreve("VOCÊ VAI ENTRAR PRA HISTÓRIA!!!");
   tela_lincol(++lin,col);
-  printf("Tecle <enter> duas vezes para seguir");
+  tela_escreve("Tecle <enter> duas vezes para seguir");
   tela_lincol(++lin,col);
-  printf("Digite seu nome >: ");
+  tela_escreve("Digite seu nome >: ");
+  tela_atualiza();
   
-  col+=18;
   int tam_nome = 30;
   char nome[tam_nome];
+  char linha[tam_nome];
   
-  int i = 0;
-  char l;
-  while (i < tam_nome-1) {
-    l = tecla_le_char();
-    if (l == '\n') {
-      break;
-    }
+  // a leitura da linha espera sem gastar processador; o eco do que é
+  // digitado é feito pelo terminal
+  tecla_le_linha(linha, tam_nome);
+  tela_invalida();
 
-    if ((l == 8 || l == 127) && i > 0) {
-      tela_lincol(lin,col);
-      printf(" ");
-      i--;
-      col--;
-      tela_lincol(lin,col+1);
-    } else if (caractere_valido(l) || l == ' ') {
-      tela_lincol(lin,++col);
-      nome[i] = l;
-      printf("%c",l);
+  // só ficam letras e espaços no nome
+  int i = 0;
+  for (int j = 0; linha[j] != '\0'; j++) {
+    if (caractere_valido(linha[j]) || linha[j] == ' ') {
+      nome[i] = linha[j];
       i++;
     }
-    tela_atualiza();
   }
   nome[i] = '\0';
 
-  // Encontra a posição correta da nova pontuação
-  int posicao_inserir = num_jogadores;
-  while (posicao_inserir > 0 && pontos > jogadores[posicao_inserir - 1].pontos) {
-    posicao_inserir--;
-  }
-
-  // Insere a nova pontuação na posição adequada
-  if (posicao_inserir < MAX_JOGADORES) {
-    // Move as pontuações existentes para abrir espaço
-    for (int i = num_jogadores - 1; i >= posicao_inserir; i--) {
-      jogadores[i + 1] = jogadores[i];
-    }
-    
-    Jogador player;
-    int j = 0;
-
-    do {
-      player.nome[j] = nome[j];
-      j++;
-    }while(nome[j] != '\0');
-
-    player.nome[j] = '\0';
-    player.pontos = pontos;
-    
-    // Insere a nova pontuação
-    jogadores[posicao_inserir] = player;
-
-    // Atualiza o número de jogadores se necessário
-    if (num_jogadores < MAX_JOGADORES) {
-      num_jogadores++;
-    }
-
-    // Escreve as três maiores pontuações no arquivo
-    for (int i = 0; i < num_jogadores; i++) {
-      fprintf(arquivo, "%d) %s - %d pontos\n", i + 1, jogadores[i].nome, jogadores[i].pontos);
-    }
-
+  if (!recordes_acrescenta(nome, pontos)) {
+    tela_lincol(++lin,col);
+    tela_escreve("Não foi possível gravar o recorde");
   }
   
   tela_atualiza();
   espera_enter();
-  fclose(arquivo);
 }
 
 /**
@@ -735,15 +484,8 @@ void atualiza_recordes(Jogador* jogadores, int num_jogadores, int pontos)
  */
 void mostra_recordes()
 {
-  FILE *arquivo;
-  arquivo = fopen("recordes.txt","r");
-
-  if (arquivo == NULL) {
-    exit(1);
-  }
-
-  int pos_ranking = 1;
-  char linha[100];
+  Jogador jogadores[MAX_JOGADORES];
+  int num_jogadores = recordes_melhores(jogadores, MAX_JOGADORES);
 
   tela_limpa();
 
@@ -751,28 +493,25 @@ void mostra_recordes()
   int col = tela_ncol() / 2 - 30/2;
   tela_lincol(lin, col); 
   tela_cor_letra(0,240,0); 
-  printf("HALL DA FAMA!!!!");
+  tela_escreve("HALL DA FAMA!!!!");
   lin++;
-  while (fgets(linha, sizeof(linha), arquivo) != NULL) {
-    if (pos_ranking == 1) {
+  for (int i = 0; i < num_jogadores; i++) {
+    if (i == 0) {
       tela_cor_letra(255,223,0);
-    } else if (pos_ranking == 2) {
+    } else if (i == 1) {
       tela_cor_letra(192,192,192);
     } else {
       tela_cor_letra(153,101,21);
     }
     tela_lincol(++lin, col);
-    printf("%s", linha);
-    pos_ranking++;
+    tela_escreve("%d) %s - %d pontos", i + 1, jogadores[i].nome, jogadores[i].pontos);
   }
   tela_lincol(lin+=2,col);
   tela_cor_letra(0,240,0); 
-  printf("Tecle <enter> para seguir");
+  tela_escreve("Tecle <enter> para seguir");
   tela_cor_normal();
   tela_atualiza();
   espera_enter();
-
-  fclose(arquivo);
 }
 
 /**
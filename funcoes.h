@@ -11,111 +11,52 @@
 #include <stdbool.h>
 #include <time.h>
 #include <string.h>
+#include <math.h>
 #include "tecla.h"
 #include "tela.h"
+#include "evento.h"
+#include "relogio.h"
+#include "dicionario.h"
+#include "regras.h"
+#include "latencia.h"
+#include "sessao.h"
+#include "recordes.h"
+#include "entrada.h"
+#include "ritmo.h"
 
 
 #ifndef JOGO_H
 #define JOGO_H
 
 // definições de constantes
-#define N_LETRA 16   /**< Número de letras a serem geradas. */
-#define N_PALAVRAS 10 /**< Número de palavras a serem geradas. */
-#define TEMPO 3 * N_PALAVRAS /**< Tempo total para digitar as palavras (em segundos). */
+#define N_PALAVRAS 10 /**< Número de palavras a serem geradas, se não for escolhido outro valor. */
 #define MAX_JOGADORES 3 /**< Número máximo de jogadores no hall da fama. */
+#define FPS_PADRAO 30 /**< Quadros por segundo, se não for escolhido outro valor. */
 
 // definições de structs
 /**
- * @brief Estrutura que representa uma palavra no jogo.
+ * @brief Opções escolhidas na linha de comando.
  */
 typedef struct {
-  char palavra[N_LETRA];   /**< Palavra a ser digitada. */
-  int pos_horizontal;      /**< Posição horizontal da palavra na tela. */
-  int hora_ativacao;       /**< Hora em que a palavra foi ativada. */
-  int tempo_digitacao;      /**< Tempo permitido para a digitação da palavra. */
-} Palavra;
-
-/**
- * @brief Estrutura que representa um jogador no hall da fama.
- */
-typedef struct {
-  char nome[50];  /**< Nome do jogador. */
-  int pontos;     /**< Pontuação do jogador. */
-} Jogador;
+  int fps;         /**< Quadros por segundo desejados durante a partida. */
+  int n_palavras;  /**< Número de palavras de uma partida. */
+  bool infinito;   /**< Se as palavras não param de surgir até uma expirar. */
+  bool headless;   /**< Se as partidas são simuladas, sem tela nem teclado. */
+  int partidas;    /**< Número de partidas simuladas. */
+  char *roteiro;   /**< Arquivo com as teclas digitadas nas partidas simuladas, ou NULL. */
+  bool latencia;   /**< Se o histograma de latência das teclas é mostrado no final. */
+  char *grava;     /**< Arquivo onde a sessão é gravada, ou NULL. */
+  char *repete;    /**< Arquivo com a sessão a repetir, ou NULL. */
+  bool rapido;     /**< Se a sessão é repetida o mais rápido possível, em vez de no tempo real. */
+  char *servidor;  /**< Socket onde o servidor de partidas espera jogadores, ou NULL. */
+  char *cliente;   /**< Socket do servidor onde jogar, ou NULL. */
+  char *carga;     /**< Socket do servidor onde gerar carga, ou NULL. */
+  int sessoes;     /**< Número de sessões abertas pelo gerador de carga. */
+  int duracao;     /**< Segundos de execução do gerador de carga. */
+} Opcoes;
 
 // definições de funções
 
-/**
- * @brief Verifica se a letra foi encontrada na palavra.
- *
- * @param palavras Vetor de palavras.
- * @param p_sel Índice da palavra selecionada.
- * @param letra Letra a ser verificada.
- * @return Retorna true se a letra foi encontrada na palavra, false caso contrário.
- */
-bool acha_letra(Palavra *palavras, int p_sel, char letra);
-
-/**
- * @brief Remove a letra digitada.
- *
- * @param palavras Vetor de palavras.
- * @param p_sel Índice da palavra selecionada.
- */
-void remove_pos(Palavra *palavras, int p_sel);
-
-/**
- * @brief Seleciona uma palavra das palavras.
- *
- * @param palavras Vetor de palavras.
- * @param n_palavras Número total de palavras.
- * @param l Letra para determinar a palavra.
- * @param inicio Tempo de início da partida.
- * @return Índice da palavra selecionada.
- */
-int seleciona_palavra(Palavra *palavras, int n_palavras, char l, double inicio);
-
-/**
- * @brief Remove a palavra selecionada após ela ser totalmente digitada.
- *
- * @param palavras Vetor de palavras.
- * @param p_sel Índice da palavra selecionada.
- */
-void remove_palavra(Palavra *palavras, int p_sel);
-
-/**
- * @brief Verifica se todas as letras da palavra selecionada foram digitadas.
- *
- * @param palavras Vetor de palavras.
- * @param p_sel Índice da palavra selecionada.
- * @return Retorna true se todas as letras foram digitadas, false caso contrário.
- */
-bool palavra_selecionada_terminou(Palavra *palavras, int p_sel);
-
-/**
- * @brief Verifica se o caractere é válido.
- *
- * @param l Caractere a ser verificado.
- * @return Retorna true se o caractere for válido, false caso contrário.
- */
-bool caractere_valido(char l);
-
-/**
- * @brief Transforma o caractere maiúsculo em minúsculo, se necessário.
- *
- * @param l Caractere a ser convertido.
- * @return Caractere convertido.
- */
-char converte_caractere(char l);
-
-/**
- * @brief Verifica se o número já foi sorteado no vetor.
- *
- * @param num Número a ser verificado.
- * @param vet Vetor de números já sorteados.
- * @return Retorna true se o número já foi sorteado, false caso contrário.
- */
-bool numero_jah_sorteado(int num, int vet[N_PALAVRAS]);
-
 /**
  * @brief Apresenta o jogo.
  */
@@ -126,13 +67,18 @@ void apresentacao();
  *
  * @param n_palavras Número total de palavras no jogo.
  * @param pontos Pontuação final do jogador.
+ * @param latencias Latências das teclas na partida.
  */
-void encerramento(int n_palavras, int pontos);
+void encerramento(int n_palavras, int pontos, const Latencias *latencias);
 
 /**
  * @brief Executa uma partida.
+ *
+ * @param opcoes Opções escolhidas na linha de comando.
+ * @param latencias Histograma onde são acumuladas as latências das teclas de todas as partidas.
+ * @param gravacao Sessão onde as teclas da partida são gravadas, ou NULL.
  */
-void jogo();
+void jogo(const Opcoes *opcoes, Latencias *latencias, Sessao *gravacao);
 
 /**
  * @brief Verifica a vontade do jogador de jogar novamente.
@@ -141,79 +87,21 @@ void jogo();
  */
 bool quer_jogar_de_novo();
 
-/**
- * @brief Preenche o vetor de palavras com palavras sorteadas.
- *
- * @param palavras Vetor de palavras.
- */
-void preenche_palavras(Palavra *palavras);
-
-/**
- * @brief Define a posição horizontal das palavras.
- *
- * @param palavras Vetor de palavras.
- */
-void preenche_pos_horizontal(Palavra *palavras);
-
-/**
- * @brief Define a hora de ativação das palavras.
- *
- * @param palavras Vetor de palavras.
- */
-void preenche_hora_ativacao(Palavra *palavras);
-
-/**
- * @brief Define o tempo para digitação das palavras.
- *
- * @param palavras Vetor de palavras.
- */
-void preenche_tempo_digitacao(Palavra *palavras);
-
 /**
  * @brief Limpa a linha de entrada.
  */
 void espera_enter();
 
 /**
- * @brief Lê uma tecla, verifica se é a correta e age de acordo.
+ * @brief Mostra o estado da partida para o usuário.
  *
- * @param palavras Vetor de palavras.
- * @param p_selecionada Índice da palavra selecionada.
- * @param n_palavras Número total de palavras.
- * @param pontos Pontuação do jogador.
- * @param inicio Tempo de início da partida.
- * @param tempo_ultima_letra Tempo da última letra digitada.
- */
-void processa_entrada(Palavra *palavras, int *p_selecionada, int *n_palavras, int *pontos, double inicio, double *tempo_ultima_letra);
-
-/**
- * @brief Mostra o estado do programa para o usuário.
+ * Enquanto nenhuma tecla é digitada e nenhuma palavra aparece, o desenho só muda quando
+ * alguma palavra desce uma linha; a hora retornada permite pular os quadros até lá.
  *
- * @param palavras Vetor de palavras.
- * @param n_palavra Índice da palavra atual.
- * @param p_selecionada Índice da palavra selecionada.
- * @param pontos Pontuação do jogador.
- * @param inicio Tempo de início da partida.
+ * @param p Partida.
+ * @return Hora da partida em que alguma palavra muda de linha, ou HUGE_VAL se nenhuma muda.
  */
-void desenha_tela(Palavra *palavras, int n_palavra, int p_selecionada, int pontos, double inicio);
-
-/**
- * @brief Retorna o tamanho da palavra.
- *
- * @param palavra Palavra a ser medida.
- * @return Tamanho da palavra.
- */
-int tam_palavra(char palavra[N_LETRA]);
-
-/**
- * @brief Verifica se o tempo de digitação da palavra expirou.
- *
- * @param palavras Vetor de palavras.
- * @param inicio Tempo de início da partida.
- * @param n_palavra Índice da palavra atual.
- * @return Retorna true se o tempo de digitação expirou, false caso contrário.
- */
-bool tempo_digitacao_expirou(Palavra *palavras, double inicio, int n_palavra);
+double desenha_tela(const Partida *p);
 
 /**
  * @brief Lê os recordes do jogo e armazena o jogador e a pontuação.
@@ -226,11 +114,9 @@ void le_recordes(Jogador *jogadores, int *num_jogadores);
 /**
  * @brief Atualiza os recordes do jogo.
  *
- * @param jogadores Vetor de jogadores.
- * @param num_jogadores Número total de jogadores.
  * @param pontos Pontuação do jogador.
  */
-void atualiza_recordes(Jogador *jogadores, int num_jogadores, int pontos);
+void atualiza_recordes(int pontos);
 
 /**
  * @brief Mostra os recordes do jogo na tela.
@@ -0,0 +1,94 @@
+/**
+ * @file indice.c
+ *
+ * @brief Implementação do índice de palavras pela primeira letra.
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#include "indice.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @brief Retorna a lista correspondente a uma letra.
+ *
+ * @param letra Letra.
+ * @return Número da lista, ou -1 se a letra não for de 'a' a 'z'.
+ */
+static int indice_lista(char letra)
+{
+  if (letra < 'a' || letra > 'z') {
+    return -1;
+  }
+  return letra - 'a';
+}
+
+void indice_ini(IndiceLetras *ind, int capacidade)
+{
+  for (int l = 0; l < INDICE_N_LETRAS; l++) {
+    ind->primeira[l] = -1;
+    ind->ultima[l] = -1;
+  }
+  ind->capacidade = capacidade;
+  ind->prox = malloc(capacidade * sizeof(int));
+  ind->ant = malloc(capacidade * sizeof(int));
+  if (ind->prox == NULL || ind->ant == NULL) {
+    perror("Sem memória para o índice");
+    exit(1);
+  }
+}
+
+void indice_fim(IndiceLetras *ind)
+{
+  free(ind->prox);
+  free(ind->ant);
+  ind->prox = ind->ant = NULL;
+  ind->capacidade = 0;
+}
+
+void indice_insere(IndiceLetras *ind, int palavra, char letra)
+{
+  int l = indice_lista(letra);
+  if (l == -1) {
+    return;
+  }
+  ind->prox[palavra] = -1;
+  ind->ant[palavra] = ind->ultima[l];
+  if (ind->ultima[l] == -1) {
+    ind->primeira[l] = palavra;
+  } else {
+    ind->prox[ind->ultima[l]] = palavra;
+  }
+  ind->ultima[l] = palavra;
+}
+
+void indice_remove(IndiceLetras *ind, int palavra, char letra)
+{
+  int l = indice_lista(letra);
+  if (l == -1) {
+    return;
+  }
+  int p = ind->prox[palavra];
+  int a = ind->ant[palavra];
+  if (a == -1) {
+    ind->primeira[l] = p;
+  } else {
+    ind->prox[a] = p;
+  }
+  if (p == -1) {
+    ind->ultima[l] = a;
+  } else {
+    ind->ant[p] = a;
+  }
+}
+
+int indice_primeira(const IndiceLetras *ind, char letra)
+{
+  int l = indice_lista(letra);
+  if (l == -1) {
+    return -1;
+  }
+  return ind->primeira[l];
+}
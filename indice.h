@@ -0,0 +1,73 @@
+/**
+ * @file indice.h
+ *
+ * @brief Definição do índice de palavras pela primeira letra.
+ *
+ * Para cada letra, as palavras disponíveis para seleção ficam em uma lista
+ * duplamente encadeada, na ordem em que foram ativadas. Inserir, remover e
+ * achar a palavra mais antiga de uma letra custam O(1).
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#ifndef INDICE_H
+#define INDICE_H
+
+#define INDICE_N_LETRAS 26 /**< Número de listas do índice (letras de 'a' a 'z'). */
+
+/**
+ * @brief Índice de palavras pela primeira letra.
+ *
+ * As palavras são identificadas por um número entre 0 e capacidade-1.
+ */
+typedef struct {
+  int primeira[INDICE_N_LETRAS];  /**< Palavra mais antiga de cada letra, ou -1. */
+  int ultima[INDICE_N_LETRAS];    /**< Palavra mais recente de cada letra, ou -1. */
+  int *prox;                      /**< Próxima palavra da mesma letra, ou -1. */
+  int *ant;                       /**< Palavra anterior da mesma letra, ou -1. */
+  int capacidade;                 /**< Número de palavras que o índice comporta. */
+} IndiceLetras;
+
+/**
+ * @brief Inicializa um índice vazio.
+ *
+ * @param ind Índice.
+ * @param capacidade Número de palavras que o índice deve comportar.
+ */
+void indice_ini(IndiceLetras *ind, int capacidade);
+
+/**
+ * @brief Libera a memória do índice.
+ *
+ * @param ind Índice.
+ */
+void indice_fim(IndiceLetras *ind);
+
+/**
+ * @brief Insere uma palavra no final da lista de sua letra.
+ *
+ * @param ind Índice.
+ * @param palavra Número da palavra.
+ * @param letra Primeira letra da palavra ('a' a 'z').
+ */
+void indice_insere(IndiceLetras *ind, int palavra, char letra);
+
+/**
+ * @brief Remove uma palavra da lista de sua letra.
+ *
+ * @param ind Índice.
+ * @param palavra Número da palavra.
+ * @param letra Primeira letra da palavra ('a' a 'z').
+ */
+void indice_remove(IndiceLetras *ind, int palavra, char letra);
+
+/**
+ * @brief Retorna a palavra ativada há mais tempo que começa com uma letra.
+ *
+ * @param ind Índice.
+ * @param letra Letra procurada.
+ * @return Número da palavra, ou -1 se não houver nenhuma.
+ */
+int indice_primeira(const IndiceLetras *ind, char letra);
+
+#endif /* INDICE_H */
@@ -0,0 +1,124 @@
+/**
+ * @file latencia.c
+ *
+ * @brief Implementação do histograma de latência entre a tecla e a tela.
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#include "latencia.h"
+
+#include <string.h>
+
+// faixa de uma latência em µs: abaixo de LATENCIA_SUBFAIXAS, uma faixa por µs;
+//   acima, a potência de 2 escolhe o grupo de faixas e os bits seguintes ao
+//   mais alto escolhem a faixa dentro do grupo
+static int faixa(long us)
+{
+  if (us < LATENCIA_SUBFAIXAS) {
+    return us < 0 ? 0 : us;
+  }
+  int e = 0;
+  while ((us >> e) >= 2 * LATENCIA_SUBFAIXAS) {
+    e++;
+  }
+  int f = LATENCIA_SUBFAIXAS * (e + 1) + (us >> e) - LATENCIA_SUBFAIXAS;
+  if (f >= LATENCIA_N_FAIXAS) {
+    return LATENCIA_N_FAIXAS - 1;
+  }
+  return f;
+}
+
+// maior latência (em µs) contada na faixa f
+static long limite(int f)
+{
+  if (f < LATENCIA_SUBFAIXAS) {
+    return f;
+  }
+  int e = f / LATENCIA_SUBFAIXAS - 1;
+  long base = f % LATENCIA_SUBFAIXAS + LATENCIA_SUBFAIXAS;
+  return ((base + 1) << e) - 1;
+}
+
+void latencia_zera(Latencias *l)
+{
+  memset(l, 0, sizeof(*l));
+}
+
+void latencia_registra(Latencias *l, double segundos)
+{
+  long us = segundos * 1e6;
+  l->faixas[faixa(us)]++;
+  l->n++;
+  if (us > l->max) {
+    l->max = us;
+  }
+}
+
+void latencia_chegada(Latencias *l, double hora)
+{
+  if (l->n_pendentes < LATENCIA_PENDENTES) {
+    l->pendentes[l->n_pendentes++] = hora;
+  }
+}
+
+void latencia_quadro(Latencias *l, double hora)
+{
+  for (int i = 0; i < l->n_pendentes; i++) {
+    latencia_registra(l, hora - l->pendentes[i]);
+  }
+  l->n_pendentes = 0;
+}
+
+void latencia_junta(Latencias *total, const Latencias *l)
+{
+  for (int f = 0; f < LATENCIA_N_FAIXAS; f++) {
+    total->faixas[f] += l->faixas[f];
+  }
+  total->n += l->n;
+  if (l->max > total->max) {
+    total->max = l->max;
+  }
+}
+
+double latencia_percentil(const Latencias *l, double percentil)
+{
+  if (l->n == 0) {
+    return 0;
+  }
+  // número de latências até o percentil, arredondado para cima
+  double exato = percentil * l->n / 100;
+  long alvo = exato;
+  if (alvo < exato) {
+    alvo++;
+  }
+  if (alvo < 1) {
+    alvo = 1;
+  }
+  long contadas = 0;
+  for (int f = 0; f < LATENCIA_N_FAIXAS; f++) {
+    contadas += l->faixas[f];
+    if (contadas >= alvo) {
+      long us = limite(f);
+      return (us < l->max ? us : l->max) * 1e-6;
+    }
+  }
+  return l->max * 1e-6;
+}
+
+double latencia_max(const Latencias *l)
+{
+  return l->max * 1e-6;
+}
+
+void latencia_despeja(const Latencias *l, FILE *arquivo)
+{
+  fprintf(arquivo, "latência tecla-tela: %ld teclas, p50 %.3f ms, p99 %.3f ms, máx %.3f ms\n",
+          l->n, latencia_percentil(l, 50) * 1e3, latencia_percentil(l, 99) * 1e3,
+          latencia_max(l) * 1e3);
+  for (int f = 0; f < LATENCIA_N_FAIXAS; f++) {
+    if (l->faixas[f] > 0) {
+      fprintf(arquivo, "  até %9.3f ms: %ld\n", limite(f) * 1e-3, l->faixas[f]);
+    }
+  }
+}
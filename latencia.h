@@ -0,0 +1,103 @@
+/**
+ * @file latencia.h
+ *
+ * @brief Definição do histograma de latência entre a tecla e a tela.
+ *
+ * A latência de uma tecla é o tempo entre sua leitura e o envio ao terminal
+ * do primeiro quadro que mostra seu efeito. As latências são contadas em
+ * faixas de tamanho fixo, como num histograma HDR: cada potência de 2 de
+ * microssegundos é dividida em LATENCIA_SUBFAIXAS faixas iguais, o que dá
+ * erro relativo de no máximo 1/LATENCIA_SUBFAIXAS. Registrar uma latência
+ * não aloca memória.
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#ifndef LATENCIA_H
+#define LATENCIA_H
+
+#include <stdio.h>
+
+#define LATENCIA_SUBFAIXAS 16 /**< Faixas em cada potência de 2. */
+#define LATENCIA_EXPOENTES 20 /**< Potências de 2 acima de LATENCIA_SUBFAIXAS µs (até uns 16 s). */
+#define LATENCIA_N_FAIXAS (LATENCIA_SUBFAIXAS * (LATENCIA_EXPOENTES + 1)) /**< Número de faixas. */
+#define LATENCIA_PENDENTES 64 /**< Teclas que podem esperar pelo próximo quadro. */
+
+/**
+ * @brief Histograma de latências, com as teclas que ainda não apareceram na tela.
+ */
+typedef struct {
+  long faixas[LATENCIA_N_FAIXAS];         /**< Número de latências em cada faixa. */
+  long n;                                 /**< Número de latências registradas. */
+  long max;                               /**< Maior latência registrada, em µs. */
+  double pendentes[LATENCIA_PENDENTES];   /**< Hora de leitura das teclas ainda não mostradas. */
+  int n_pendentes;                        /**< Número de teclas pendentes. */
+} Latencias;
+
+/**
+ * @brief Esvazia o histograma.
+ *
+ * @param l Histograma.
+ */
+void latencia_zera(Latencias *l);
+
+/**
+ * @brief Registra uma latência.
+ *
+ * @param l Histograma.
+ * @param segundos Latência, em segundos.
+ */
+void latencia_registra(Latencias *l, double segundos);
+
+/**
+ * @brief Anota a chegada de uma tecla, que fica pendente até o próximo quadro.
+ *
+ * Se houver LATENCIA_PENDENTES teclas pendentes, a tecla não é anotada.
+ *
+ * @param l Histograma.
+ * @param hora Hora em que a tecla foi lida (relógio monotônico, em segundos).
+ */
+void latencia_chegada(Latencias *l, double hora);
+
+/**
+ * @brief Registra a latência de todas as teclas pendentes, cujo efeito acaba de ser mostrado.
+ *
+ * @param l Histograma.
+ * @param hora Hora em que o quadro foi enviado ao terminal.
+ */
+void latencia_quadro(Latencias *l, double hora);
+
+/**
+ * @brief Acrescenta a um histograma as latências registradas em outro.
+ *
+ * @param total Histograma que recebe as latências.
+ * @param l Histograma com as latências a acrescentar.
+ */
+void latencia_junta(Latencias *total, const Latencias *l);
+
+/**
+ * @brief Calcula um percentil das latências registradas.
+ *
+ * @param l Histograma.
+ * @param percentil Percentil desejado, entre 0 e 100.
+ * @return Maior latência da faixa do percentil, em segundos (0 se não houver latências).
+ */
+double latencia_percentil(const Latencias *l, double percentil);
+
+/**
+ * @brief Retorna a maior latência registrada.
+ *
+ * @param l Histograma.
+ * @return Maior latência, em segundos.
+ */
+double latencia_max(const Latencias *l);
+
+/**
+ * @brief Escreve o histograma em um arquivo: percentis, máximo e as faixas não vazias.
+ *
+ * @param l Histograma.
+ * @param arquivo Arquivo onde escrever.
+ */
+void latencia_despeja(const Latencias *l, FILE *arquivo);
+
+#endif /* LATENCIA_H */
@@ -0,0 +1,290 @@
+/**
+ * @file recordes.c
+ *
+ * @brief Implementação do arquivo de recordes.
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#include "recordes.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <errno.h>
+
+#define MAGICO "FWR1" /**< Início do arquivo de recordes. */
+#define TAM_MAGICO 4 /**< Bytes do MAGICO. */
+#define TAM_REGISTRO (1 + RECORDES_N_NOME + 4 + 1) /**< Maior tamanho de um registro. */
+#define COMPACTA (2 * RECORDES_MAX) /**< Registros no arquivo que disparam a compactação. */
+#define TRAVA RECORDES_ARQUIVO ".trava" /**< Arquivo travado por quem escreve recordes. */
+
+// recordes em memória, em ordem decrescente de pontos, e o estado do
+//   arquivo quando foram lidos
+static Jogador cache[RECORDES_MAX];
+static int n_cache;
+static bool cache_valido;
+static struct timespec cache_mtime;
+static off_t cache_tamanho;
+// registros no arquivo, inclusive os que não estão entre os RECORDES_MAX
+static int n_registros;
+// bytes do arquivo que contêm registros completos
+static off_t tamanho_valido;
+
+// byte de verificação de um registro
+static unsigned char soma(const unsigned char *bytes, int n)
+{
+  unsigned char s = 0xa5;
+  for (int i = 0; i < n; i++) {
+    s = (s << 1 | s >> 7) ^ bytes[i];
+  }
+  return s;
+}
+
+// monta em reg o registro de um recorde; retorna seu tamanho
+static int monta_registro(unsigned char *reg, const char *nome, int pontos)
+{
+  int tam = strlen(nome);
+  if (tam > RECORDES_N_NOME - 1) {
+    tam = RECORDES_N_NOME - 1;
+  }
+  reg[0] = tam;
+  memcpy(reg + 1, nome, tam);
+  unsigned int p = pontos;
+  for (int i = 0; i < 4; i++) {
+    reg[1 + tam + i] = p >> (8 * i);
+  }
+  reg[1 + tam + 4] = soma(reg, 1 + tam + 4);
+  return 1 + tam + 4 + 1;
+}
+
+// coloca um recorde no cache, depois dos que têm pontos iguais ou maiores
+static void insere_cache(const char *nome, int tam, int pontos)
+{
+  int pos = n_cache;
+  while (pos > 0 && pontos > cache[pos - 1].pontos) {
+    pos--;
+  }
+  if (pos >= RECORDES_MAX) {
+    return;
+  }
+  if (n_cache < RECORDES_MAX) {
+    n_cache++;
+  }
+  memmove(&cache[pos + 1], &cache[pos], (n_cache - 1 - pos) * sizeof(Jogador));
+  memcpy(cache[pos].nome, nome, tam);
+  cache[pos].nome[tam] = '\0';
+  cache[pos].pontos = pontos;
+}
+
+// lê os registros de um arquivo aberto para o cache; para no primeiro
+//   registro incompleto ou corrompido
+static void le_registros(FILE *arquivo)
+{
+  char magico[TAM_MAGICO];
+  tamanho_valido = 0;
+  if (fread(magico, 1, TAM_MAGICO, arquivo) != TAM_MAGICO || memcmp(magico, MAGICO, TAM_MAGICO) != 0) {
+    return;
+  }
+  tamanho_valido = TAM_MAGICO;
+  unsigned char reg[TAM_REGISTRO];
+  int c;
+  while ((c = fgetc(arquivo)) != EOF) {
+    reg[0] = c;
+    int tam = reg[0];
+    if (tam > RECORDES_N_NOME - 1 || fread(reg + 1, 1, tam + 5, arquivo) != (size_t)tam + 5
+        || soma(reg, 1 + tam + 4) != reg[1 + tam + 4]) {
+      break;
+    }
+    unsigned int p = 0;
+    for (int i = 0; i < 4; i++) {
+      p |= (unsigned int)reg[1 + tam + i] << (8 * i);
+    }
+    insere_cache((char *)reg + 1, tam, (int)p);
+    n_registros++;
+    tamanho_valido += 1 + tam + 5;
+  }
+}
+
+// importa os recordes do arquivo de texto antigo para o cache
+static void importa_texto(void)
+{
+  FILE *arquivo = fopen(RECORDES_TEXTO, "r");
+  if (arquivo == NULL) {
+    return;
+  }
+  char linha[100];
+  char nome[RECORDES_N_NOME];
+  int pontos;
+  while (fgets(linha, sizeof(linha), arquivo) != NULL) {
+    if (sscanf(linha, "%*d) %49[^-] - %d pontos", nome, &pontos) == 2) {
+      int tam = strlen(nome);
+      // retira o espaço antes do '-'
+      if (tam > 0 && nome[tam - 1] == ' ') {
+        tam--;
+      }
+      insere_cache(nome, tam, pontos);
+    }
+  }
+  fclose(arquivo);
+}
+
+// escreve os recordes do cache em um arquivo novo, que substitui o atual
+static bool compacta(void)
+{
+  const char *temp = RECORDES_ARQUIVO ".tmp";
+  int fd = open(temp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd == -1) {
+    return false;
+  }
+  unsigned char *buf = malloc(TAM_MAGICO + n_cache * TAM_REGISTRO);
+  if (buf == NULL) {
+    close(fd);
+    unlink(temp);
+    return false;
+  }
+  memcpy(buf, MAGICO, TAM_MAGICO);
+  int n = TAM_MAGICO;
+  for (int i = 0; i < n_cache; i++) {
+    n += monta_registro(buf + n, cache[i].nome, cache[i].pontos);
+  }
+  bool ok = write(fd, buf, n) == n && fsync(fd) == 0;
+  free(buf);
+  ok = close(fd) == 0 && ok;
+  // rename troca o arquivo de uma só vez: quem abrir o arquivo vê o
+  //   antigo ou o novo, nunca um pela metade
+  if (!ok || rename(temp, RECORDES_ARQUIVO) != 0) {
+    unlink(temp);
+    return false;
+  }
+  n_registros = n_cache;
+  tamanho_valido = n;
+  return true;
+}
+
+// espera até conseguir a trava dos escritores; retorna o descritor a
+//   passar para destrava, ou -1 se não foi possível travar
+static int trava(void)
+{
+  int fd = open(TRAVA, O_RDWR | O_CREAT, 0644);
+  if (fd == -1) {
+    return -1;
+  }
+  while (flock(fd, LOCK_EX) != 0) {
+    if (errno != EINTR) {
+      close(fd);
+      return -1;
+    }
+  }
+  return fd;
+}
+
+// libera a trava dos escritores
+static void destrava(int fd)
+{
+  if (fd != -1) {
+    close(fd);
+  }
+}
+
+// guarda a data e o tamanho do arquivo, para saber quando o cache fica velho
+static void marca_cache(void)
+{
+  struct stat st;
+  if (stat(RECORDES_ARQUIVO, &st) == 0) {
+    cache_mtime = st.st_mtim;
+    cache_tamanho = st.st_size;
+    cache_valido = true;
+  }
+}
+
+// lê os recordes do arquivo, se ele mudou desde a última leitura;
+//   travado diz se quem chama já tem a trava dos escritores
+static void atualiza_cache(bool travado)
+{
+  struct stat st;
+  if (stat(RECORDES_ARQUIVO, &st) != 0) {
+    // primeira execução com o arquivo novo: importa os recordes antigos,
+    //   se outro processo não tiver feito isso enquanto se esperava a trava
+    int fd = travado ? -1 : trava();
+    if (stat(RECORDES_ARQUIVO, &st) != 0) {
+      n_cache = n_registros = 0;
+      importa_texto();
+      compacta();
+      marca_cache();
+      destrava(fd);
+      return;
+    }
+    destrava(fd);
+  }
+  if (cache_valido && st.st_size == cache_tamanho
+      && st.st_mtim.tv_sec == cache_mtime.tv_sec && st.st_mtim.tv_nsec == cache_mtime.tv_nsec) {
+    return;
+  }
+  FILE *arquivo = fopen(RECORDES_ARQUIVO, "rb");
+  if (arquivo == NULL) {
+    return;
+  }
+  n_cache = n_registros = 0;
+  le_registros(arquivo);
+  fclose(arquivo);
+  cache_mtime = st.st_mtim;
+  cache_tamanho = st.st_size;
+  cache_valido = true;
+}
+
+int recordes_melhores(Jogador *jogadores, int max)
+{
+  atualiza_cache(false);
+  int n = n_cache < max ? n_cache : max;
+  memcpy(jogadores, cache, n * sizeof(Jogador));
+  return n;
+}
+
+bool recordes_acrescenta(const char *nome, int pontos)
+{
+  int trava_fd = trava();
+  if (trava_fd == -1) {
+    return false;
+  }
+  // com a trava, ninguém mais escreve; relê o que os outros processos
+  //   escreveram desde a última leitura (a data do arquivo pode não mudar
+  //   entre duas escritas muito próximas)
+  cache_valido = false;
+  atualiza_cache(true);
+  unsigned char reg[TAM_REGISTRO];
+  int tam = monta_registro(reg, nome, pontos);
+  bool ok;
+  if (tamanho_valido < TAM_MAGICO) {
+    // arquivo sem cabeçalho válido: recomeça com o que foi possível ler
+    insere_cache((char *)reg + 1, reg[0], pontos);
+    ok = compacta();
+    marca_cache();
+    destrava(trava_fd);
+    return ok;
+  }
+  int fd = open(RECORDES_ARQUIVO, O_WRONLY);
+  // descarta o que sobrou de uma escrita interrompida
+  ok = fd != -1 && ftruncate(fd, tamanho_valido) == 0 && lseek(fd, 0, SEEK_END) != -1
+       && write(fd, reg, tam) == tam && fsync(fd) == 0;
+  if (fd != -1) {
+    ok = close(fd) == 0 && ok;
+  }
+  if (ok) {
+    insere_cache((char *)reg + 1, reg[0], pontos);
+    n_registros++;
+    tamanho_valido += tam;
+    if (n_registros >= COMPACTA) {
+      compacta();
+    }
+    marca_cache();
+  } else {
+    cache_valido = false;
+  }
+  destrava(trava_fd);
+  return ok;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file recordes.h
+ *
+ * @brief Definição do arquivo de recordes.
+ *
+ * Os recordes ficam em um arquivo binário em que cada pontuação é um
+ * registro acrescentado no final: o tamanho do nome, o nome, os pontos (4
+ * bytes, o menos significativo primeiro) e um byte de verificação. Um
+ * registro só é escrito depois que o jogador digitou o nome, com uma única
+ * chamada a write; se o programa for interrompido no meio, o registro
+ * incompleto é ignorado na leitura e descartado na próxima escrita.
+ *
+ * Quando o arquivo acumula registros demais, ele é compactado: os
+ * RECORDES_MAX melhores são escritos em um arquivo temporário, que toma o
+ * lugar do original com rename, de uma só vez.
+ *
+ * Os recordes lidos ficam em memória e só são lidos de novo quando a data
+ * de modificação ou o tamanho do arquivo mudam.
+ *
+ * Vários processos podem usar o mesmo arquivo ao mesmo tempo. Quem escreve
+ * pega uma trava (flock) em um arquivo separado, que não é trocado pela
+ * compactação, e relê os recordes antes de acrescentar o seu: nenhum
+ * recorde de outro processo se perde. Quem só lê não pega a trava, pois um
+ * registro sendo escrito parece incompleto e é ignorado, e rename troca o
+ * arquivo de uma só vez.
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#ifndef RECORDES_H
+#define RECORDES_H
+
+#include <stdbool.h>
+
+#define RECORDES_ARQUIVO "recordes.dat" /**< Arquivo dos recordes. */
+#define RECORDES_TEXTO "recordes.txt" /**< Arquivo de recordes antigo, importado se RECORDES_ARQUIVO não existir. */
+#define RECORDES_MAX 100 /**< Número de recordes mantidos na compactação. */
+#define RECORDES_N_NOME 50 /**< Tamanho do vetor do nome de um jogador. */
+
+/**
+ * @brief Estrutura que representa um jogador no hall da fama.
+ */
+typedef struct {
+  char nome[RECORDES_N_NOME];  /**< Nome do jogador. */
+  int pontos;                  /**< Pontuação do jogador. */
+} Jogador;
+
+/**
+ * @brief Copia os melhores recordes, em ordem decrescente de pontos.
+ *
+ * Empates ficam na ordem em que os recordes foram feitos.
+ *
+ * @param jogadores Onde copiar os recordes.
+ * @param max Número máximo de recordes a copiar.
+ * @return Número de recordes copiados.
+ */
+int recordes_melhores(Jogador *jogadores, int max);
+
+/**
+ * @brief Acrescenta um recorde ao arquivo, compactando-o se necessário.
+ *
+ * @param nome Nome do jogador (é cortado se não couber em Jogador).
+ * @param pontos Pontuação do jogador.
+ * @return Retorna true se o recorde foi gravado, false caso contrário.
+ */
+bool recordes_acrescenta(const char *nome, int pontos);
+
+#endif /* RECORDES_H */
@@ -0,0 +1,503 @@
+/**
+ * @file regras.c
+ *
+ * @brief Implementação das regras do jogo de digitação.
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "regras.h"
+#include "dicionario.h"
+
+/**
+ * @brief Prepara uma partida, sorteando suas palavras.
+ *
+ * Cada palavra ocupa uma vaga da reserva; o número da vaga identifica a palavra.
+ * No modo infinito as palavras surgem durante a partida, reaproveitando as vagas
+ * das que já foram digitadas.
+ *
+ * @param p Partida.
+ * @param n_palavras Número de palavras da partida (fora do modo infinito).
+ * @param infinito Se as palavras não param de surgir até uma expirar.
+ */
+void partida_ini(Partida *p, int n_palavras, bool infinito)
+{
+  reserva_ini(&p->reserva, infinito ? VAGAS_INFINITO : n_palavras);
+  if (!infinito) {
+    for (int i = 0; i < n_palavras; i++) {
+      reserva_pega(&p->reserva);
+    }
+    preenche_palavras(&p->reserva);
+    preenche_pos_horizontal(&p->reserva);
+    preenche_hora_ativacao(&p->reserva);
+    preenche_tempo_digitacao(&p->reserva);
+  }
+  p->infinito = infinito;
+  p->tempo_total = TEMPO_POR_PALAVRA * n_palavras;
+  p->proximo_nascimento = 0.0;
+  p->agora = 0.0;
+  p->selecionada = -1;
+  p->pontos = 0;
+  // a primeira letra não ganha bônus de rapidez
+  p->tempo_ultima_letra = -1.0;
+  p->terminou = false;
+
+  // palavras disponíveis para seleção, por primeira letra
+  indice_ini(&p->indice, p->reserva.capacidade);
+  // próximo prazo de cada palavra: a hora de aparecer e, depois, a de expirar
+  agenda_ini(&p->agenda, p->reserva.capacidade);
+  agenda_palavras(&p->reserva, &p->agenda);
+}
+
+/**
+ * @brief Libera a memória usada pela partida.
+ *
+ * @param p Partida.
+ */
+void partida_fim(Partida *p)
+{
+  indice_fim(&p->indice);
+  agenda_fim(&p->agenda);
+  reserva_fim(&p->reserva);
+}
+
+/**
+ * @brief Faz a partida chegar na hora dada.
+ *
+ * Surgem e aparecem as palavras cuja hora chegou. Como as palavras nascem e aparecem nas
+ * horas marcadas, tanto faz chegar numa hora de uma vez ou em vários passos menores.
+ *
+ * @param p Partida.
+ * @param hora Nova hora da partida, em segundos; nunca anterior à hora atual.
+ * @param oc Onde contar as palavras que apareceram.
+ * @return true se o tempo de alguma palavra expirou.
+ */
+static bool avanca_ate(Partida *p, double hora, Ocorrencias *oc)
+{
+  if (hora > p->agora) {
+    p->agora = hora;
+  }
+  if (p->infinito) {
+    gera_palavras(p);
+  }
+  ativa_palavras(p, oc);
+  return tempo_digitacao_expirou(p);
+}
+
+/**
+ * @brief Executa um passo da partida.
+ *
+ * Cada tecla é processada na hora em que chegou: antes dela, a partida avança até essa hora
+ * (e acaba ali, se o tempo de alguma palavra já tinha expirado). Depois das teclas, a partida
+ * avança até a hora do passo. Assim o resultado depende só das horas das teclas, e não de
+ * quando os passos são executados. A partida acaba quando o tempo de alguma palavra expira
+ * ou, fora do modo infinito, quando acabam as palavras ou o tempo total.
+ *
+ * @param p Partida.
+ * @param agora Hora do passo, em segundos desde o início da partida.
+ * @param teclas Teclas digitadas desde o passo anterior.
+ * @param horas Hora em que chegou cada tecla, em segundos desde o início da partida, em ordem
+ *              crescente; horas fora do intervalo entre o passo anterior e agora são
+ *              ajustadas para ele. Se NULL, todas as teclas chegaram agora.
+ * @param n_teclas Número de teclas.
+ * @param oc Onde contar o que aconteceu no passo.
+ */
+void partida_passo(Partida *p, double agora, const char *teclas, const double *horas,
+                   int n_teclas, Ocorrencias *oc)
+{
+  *oc = (Ocorrencias){ 0 };
+  if (p->terminou) {
+    oc->fim = true;
+    return;
+  }
+  for (int i = 0; i < n_teclas; i++) {
+    double hora = horas == NULL || horas[i] > agora ? agora : horas[i];
+    if (avanca_ate(p, hora, oc)) {
+      oc->expirou = true;
+      p->terminou = true;
+      oc->fim = true;
+      return;
+    }
+    processa_entrada(p, teclas[i], oc);
+  }
+  if (avanca_ate(p, agora, oc)) {
+    oc->expirou = true;
+    p->terminou = true;
+  } else if (!p->infinito && (p->reserva.n == 0 || p->agora >= p->tempo_total)) {
+    p->terminou = true;
+  }
+  oc->fim = p->terminou;
+}
+
+
+/**
+ * @brief Preenche a matriz de palavras a serem usadas no jogo.
+ *
+ * Esta função sorteia palavras do dicionário (o arquivo "palavras", já carregado em memória)
+ * e preenche a matriz de palavras, garantindo que não sejam repetidas. O dicionário só contém
+ * palavras válidas, então todas as sorteadas são usadas. Se o dicionário tiver menos palavras
+ * que as vagas ocupadas, as vagas que ficaram sem palavra são devolvidas.
+ *
+ * @param reserva Reserva cujas vagas ocupadas serão preenchidas.
+ */
+void preenche_palavras(Reserva *reserva)
+{
+	int *numeros_sorteados = malloc(reserva->n * sizeof(int));
+	if (numeros_sorteados == NULL) {
+		perror("Sem memória para sortear as palavras");
+		exit(1);
+	}
+	int n = dicionario_sorteia(numeros_sorteados, reserva->n);
+
+	for (int i = 0; i < n; i++) {
+		copia_palavra(reserva, reserva->ocupadas[i], numeros_sorteados[i]);
+	}
+	// de trás para frente, para que as vagas preenchidas não mudem de lugar
+	for (int i = reserva->n - 1; i >= n; i--) {
+		reserva_devolve(reserva, reserva->ocupadas[i]);
+	}
+	free(numeros_sorteados);
+}
+
+/**
+ * @brief Copia uma palavra do dicionário, em minúsculas, para uma vaga da reserva.
+ *
+ * O tamanho da palavra fica guardado, e nenhuma letra está digitada.
+ *
+ * @param reserva Reserva.
+ * @param vaga Vaga a preencher.
+ * @param i Índice da palavra no dicionário.
+ */
+void copia_palavra(Reserva *reserva, int vaga, int i)
+{
+  int tam;
+  const char *linha = dicionario_palavra(i, &tam);
+  char *letras = reserva->letras[vaga];
+
+  // adiciona caracteres na matriz
+  for (int j = 0; j < tam; j++) {
+    letras[j] = converte_caractere(linha[j]);
+  }
+  letras[tam] = '\0';
+  reserva->tam[vaga] = tam;
+  reserva->digitadas[vaga] = 0;
+}
+
+/**
+ * @brief Coloca em jogo uma palavra nova, sorteada do dicionário.
+ *
+ * A palavra ocupa uma vaga livre da reserva e entra na agenda para aparecer na hora dada.
+ * Se a reserva estiver cheia, ou o dicionário vazio, nenhuma palavra é criada.
+ *
+ * @param partida Partida.
+ * @param hora Hora de ativação da palavra.
+ * @return Retorna true se a palavra foi criada, false caso contrário.
+ */
+bool nasce_palavra(Partida *partida, double hora)
+{
+  int vaga = reserva_pega(&partida->reserva);
+  if (vaga == -1) {
+    return false;
+  }
+  Reserva *r = &partida->reserva;
+  int sorteada;
+  if (dicionario_sorteia(&sorteada, 1) != 1) {
+    reserva_devolve(r, vaga);
+    return false;
+  }
+  copia_palavra(r, vaga, sorteada);
+  r->pos_horizontal[vaga] = rand() % 101;
+  r->hora_ativacao[vaga] = hora;
+  r->tempo_digitacao[vaga] = rand() % 26 + 5;
+  r->ativa[vaga] = false;
+  agenda_marca(&partida->agenda, vaga, hora);
+  return true;
+}
+
+/**
+ * @brief Calcula o intervalo até a próxima palavra surgir no modo infinito.
+ *
+ * O intervalo começa em INTERVALO_INICIAL e diminui com o tempo, até chegar a INTERVALO_MINIMO.
+ *
+ * @param hora Hora em que surgiu a palavra anterior.
+ * @return Intervalo, em segundos.
+ */
+double intervalo_nascimento(double hora)
+{
+  double intervalo = INTERVALO_INICIAL / (1 + hora / RAMPA);
+  if (intervalo < INTERVALO_MINIMO) {
+    return INTERVALO_MINIMO;
+  }
+  return intervalo;
+}
+
+/**
+ * @brief Faz surgir as palavras do modo infinito cuja hora chegou.
+ *
+ * Cada palavra surge exatamente na sua hora, mesmo que o quadro atrase; a memória usada
+ * não cresce, pois as palavras ocupam as vagas da reserva.
+ *
+ * @param p Partida.
+ */
+void gera_palavras(Partida *p)
+{
+  while (p->proximo_nascimento <= p->agora) {
+    nasce_palavra(p, p->proximo_nascimento);
+    p->proximo_nascimento += intervalo_nascimento(p->proximo_nascimento);
+  }
+}
+
+/**
+ * @brief Verifica se uma linha do arquivo de palavras pode ser usada no jogo.
+ *
+ * A palavra deve caber no vetor de letras e ter somente caracteres válidos.
+ *
+ * @param palavra Letras da palavra (sem '\0' no final).
+ * @param tam Número de letras.
+ * @return Retorna true se a palavra pode ser usada, false caso contrário.
+ */
+bool palavra_valida(const char *palavra, int tam)
+{
+  if (tam == 0 || tam >= N_LETRA) {
+    return false;
+  }
+  for (int i = 0; i < tam; i++) {
+    if (!caractere_valido(palavra[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Seleciona uma palavra com base na primeira letra e no tempo de ativação.
+ *
+ * Entre as palavras já ativadas que começam com a letra, escolhe a ativada há mais tempo.
+ * A palavra escolhida sai do índice, pois deixa de estar disponível para seleção.
+ *
+ * @param indice Índice das palavras disponíveis, por primeira letra.
+ * @param l Primeira letra da palavra desejada.
+ * @return Retorna a posição da palavra selecionada no array ou -1 se nenhuma palavra for selecionada.
+ */
+int seleciona_palavra(IndiceLetras *indice, char l)
+{
+  int pos = indice_primeira(indice, l);
+  if (pos != -1) {
+    indice_remove(indice, pos, l);
+  }
+  return pos;
+}
+
+/**
+ * @brief Coloca todas as palavras na agenda, com prazo na hora de ativação.
+ *
+ * @param reserva Reserva com as palavras do jogo.
+ * @param agenda Agenda de prazos das palavras.
+ */
+void agenda_palavras(Reserva *reserva, Agenda *agenda)
+{
+  for (int i = 0; i < reserva->n; i++) {
+    int vaga = reserva->ocupadas[i];
+    reserva->ativa[vaga] = false;
+    agenda_marca(agenda, vaga, reserva->hora_ativacao[vaga]);
+  }
+}
+
+/**
+ * @brief Coloca no índice as palavras cuja hora de ativação chegou.
+ *
+ * Somente as palavras do começo da agenda são examinadas. Cada palavra ativada passa a ter
+ * como prazo o fim de seu tempo de digitação.
+ *
+ * @param p Partida.
+ * @param oc Onde contar as palavras ativadas.
+ */
+void ativa_palavras(Partida *p, Ocorrencias *oc)
+{
+  Reserva *r = &p->reserva;
+  int i = agenda_primeira(&p->agenda);
+  while (i != -1 && !r->ativa[i] && agenda_prazo(&p->agenda, i) <= p->agora) {
+    r->ativa[i] = true;
+    indice_insere(&p->indice, i, r->letras[i][0]);
+    agenda_marca(&p->agenda, i, r->hora_ativacao[i] + r->tempo_digitacao[i]);
+    oc->ativadas++;
+    i = agenda_primeira(&p->agenda);
+  }
+}
+
+/**
+ * @brief Verifica se a letra fornecida é a próxima letra a digitar da palavra selecionada.
+ *
+ * @param reserva Reserva com as palavras do jogo.
+ * @param p_sel Posição da palavra selecionada.
+ * @param letra Letra fornecida.
+ * @return Retorna true se a letra corresponder à próxima letra da palavra selecionada, false caso contrário.
+ */
+bool acha_letra(const Reserva *reserva, int p_sel, char letra)
+{
+  return reserva->letras[p_sel][reserva->digitadas[p_sel]] == letra;
+}
+
+/**
+ * @brief Marca como digitada a próxima letra da palavra selecionada.
+ *
+ * As letras não mudam de lugar: só o cursor de letras digitadas avança.
+ *
+ * @param reserva Reserva com as palavras do jogo.
+ * @param p_sel Posição da palavra selecionada.
+ */
+void remove_pos(Reserva *reserva, int p_sel)
+{
+  if (reserva->digitadas[p_sel] < reserva->tam[p_sel]) {
+    reserva->digitadas[p_sel]++;
+  }
+}
+
+/**
+ * @brief Verifica se a palavra selecionada foi completamente digitada.
+ *
+ * @param reserva Reserva com as palavras do jogo.
+ * @param p_sel Posição da palavra selecionada.
+ * @return Retorna true se a palavra foi completamente digitada, false caso contrário.
+ */
+bool palavra_selecionada_terminou(const Reserva *reserva, int p_sel)
+{
+  if (p_sel != -1 && reserva->digitadas[p_sel] == reserva->tam[p_sel]) {
+    return true;
+  } else {
+    return false;   
+  }
+}
+
+/**
+ * @brief Verifica se o caractere fornecido é uma letra válida.
+ *
+ * Um caractere é válido se for de a-z ou A-Z sem acentos e/ou caracteres especiais.
+ * 
+ * @param l Caractere fornecido.
+ * @return Retorna true se o caractere for uma letra válida, false caso contrário.
+ */
+bool caractere_valido(char l)
+{
+	if((l >= 'A' && l <= 'Z') || (l >= 'a' && l <= 'z')) {
+		return true;
+	} else {
+		return false;
+  }
+}
+
+/**
+ * @brief Converte um caractere para minúsculo, se for uma letra maiúscula.
+ *
+ * @param l Caractere fornecido.
+ * @return Retorna o caractere convertido para minúsculo, se for uma letra maiúscula; caso contrário, retorna o caractere original.
+ */
+char converte_caractere(char l)
+{
+	if (l >= 'A' && l <= 'Z') {
+		return l + 32;
+  } else {
+		return l;
+  }
+}
+
+/**
+ * @brief Processa uma tecla digitada pelo jogador, atualizando o estado do jogo.
+ *
+ * As palavras totalmente digitadas saem da agenda e liberam sua vaga na reserva.
+ *
+ * @param p Partida.
+ * @param letra Tecla digitada.
+ * @param oc Onde contar acertos, erros e palavras completas.
+ */
+void processa_entrada(Partida *p, char letra, Ocorrencias *oc)
+{
+  Reserva *palavras = &p->reserva;
+
+  if(p->selecionada == -1){
+    p->selecionada = seleciona_palavra(&p->indice,letra);
+  }
+    
+  //se tem palavra selecionada e a letra esta correta, remove a letra
+  if (p->selecionada != -1) {
+    if (acha_letra(palavras,p->selecionada,letra)) {
+      remove_pos(palavras, p->selecionada);
+      if (p->agora - p->tempo_ultima_letra >= 1) {
+        p->pontos += 1;
+      } else {
+        p->pontos += 100 * (1 - (p->agora - p->tempo_ultima_letra));
+      }
+      p->tempo_ultima_letra = p->agora;
+      oc->acertos++;
+      
+    } else if(letra != '\0') {  
+      if (p->pontos - 10 < 0){
+        p->pontos = 0;
+      } else {
+        p->pontos -= 10; 
+      }
+      p->tempo_ultima_letra = p->agora;
+      oc->erros++;
+    }    
+  } 
+
+  //Se já terminou a palavra selecionada
+  if (p->selecionada != -1 && palavra_selecionada_terminou(palavras,p->selecionada) ) {
+    agenda_remove(&p->agenda, p->selecionada);
+    reserva_devolve(&p->reserva, p->selecionada);
+    p->selecionada = -1;
+    oc->completas++;
+  }
+}
+
+/**
+ * @brief Preenche as posições horizontais das palavras da reserva.
+ *
+ * @param reserva Reserva com as palavras do jogo.
+ */
+void preenche_pos_horizontal(Reserva *reserva)
+{
+  for (int i = 0; i < reserva->n; i++) {
+    reserva->pos_horizontal[reserva->ocupadas[i]] = rand() % 101;
+  } 
+}
+
+/**
+ * @brief Preenche as horas de ativação das palavras da reserva.
+ *
+ * @param reserva Reserva com as palavras do jogo.
+ */
+void preenche_hora_ativacao(Reserva *reserva)
+{
+  for (int i = 0; i < reserva->n; i++) {
+    reserva->hora_ativacao[reserva->ocupadas[i]] = rand() % (reserva->n * 2 + 1);
+  } 
+}
+
+/**
+ * @brief Preenche os tempos de digitação das palavras da reserva.
+ *
+ * @param reserva Reserva com as palavras do jogo.
+ */
+void preenche_tempo_digitacao(Reserva *reserva)
+{
+  for (int i = 0; i < reserva->n; i++) {
+    reserva->tempo_digitacao[reserva->ocupadas[i]] = rand() % 26 + 5;
+  } 
+}
+
+/**
+ * @brief Verifica se o tempo de digitação de alguma palavra expirou.
+ *
+ * Basta olhar a palavra de menor prazo na agenda: se ela não expirou, nenhuma outra expirou.
+ *
+ * @param p Partida.
+ * @return Retorna true se o tempo de digitação de alguma palavra expirou, false caso contrário.
+ */
+bool tempo_digitacao_expirou(const Partida *p)
+{
+  int i = agenda_primeira(&p->agenda);
+  return i != -1 && p->reserva.ativa[i] && p->agora > agenda_prazo(&p->agenda, i);
+}
@@ -0,0 +1,249 @@
+/**
+ * @file regras.h
+ *
+ * @brief Definição das regras do jogo de digitação.
+ *
+ * As regras não usam a tela, o teclado nem o relógio do sistema: a cada
+ * passo recebem a hora e as teclas digitadas, atualizam o estado da partida
+ * e contam o que aconteceu. Assim uma partida pode ser executada sem
+ * terminal, com tempo virtual.
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#ifndef REGRAS_H
+#define REGRAS_H
+
+#include <stdbool.h>
+#include "reserva.h"
+#include "indice.h"
+#include "agenda.h"
+
+// definições de constantes
+#define TEMPO_POR_PALAVRA 3 /**< Tempo total para digitar as palavras (em segundos), por palavra. */
+#define VAGAS_INFINITO 4096 /**< Número máximo de palavras em jogo ao mesmo tempo no modo infinito. */
+#define INTERVALO_INICIAL 2.0 /**< Segundos entre o surgimento de palavras no início do modo infinito. */
+#define INTERVALO_MINIMO 0.02 /**< Menor intervalo (em segundos) entre o surgimento de palavras. */
+#define RAMPA 20.0 /**< A cada RAMPA segundos, palavras surgem INTERVALO_INICIAL / RAMPA mais rápido. */
+
+// definições de structs
+/**
+ * @brief Estado de uma partida.
+ */
+typedef struct {
+  Reserva reserva;            /**< Palavras em jogo; o número da vaga identifica a palavra. */
+  IndiceLetras indice;        /**< Palavras disponíveis para seleção, por primeira letra. */
+  Agenda agenda;              /**< Próximo prazo de cada palavra (aparecer ou expirar). */
+  bool infinito;              /**< Se as palavras não param de surgir até uma expirar. */
+  double tempo_total;         /**< Duração máxima da partida (fora do modo infinito). */
+  double proximo_nascimento;  /**< Hora em que surge a próxima palavra no modo infinito. */
+  double agora;               /**< Hora do último passo. */
+  int selecionada;            /**< Vaga da palavra selecionada, ou -1. */
+  int pontos;                 /**< Pontuação do jogador. */
+  double tempo_ultima_letra;  /**< Hora da última letra digitada. */
+  bool terminou;              /**< Se a partida acabou. */
+} Partida;
+
+/**
+ * @brief O que aconteceu em um passo da partida.
+ */
+typedef struct {
+  int ativadas;    /**< Palavras que apareceram. */
+  int acertos;     /**< Letras digitadas corretamente. */
+  int erros;       /**< Letras digitadas erradas. */
+  int completas;   /**< Palavras totalmente digitadas. */
+  bool expirou;    /**< Se o tempo de alguma palavra acabou. */
+  bool fim;        /**< Se a partida acabou. */
+} Ocorrencias;
+
+// definições de funções
+
+/**
+ * @brief Prepara uma partida, sorteando suas palavras.
+ *
+ * @param p Partida.
+ * @param n_palavras Número de palavras da partida (fora do modo infinito).
+ * @param infinito Se as palavras não param de surgir até uma expirar.
+ */
+void partida_ini(Partida *p, int n_palavras, bool infinito);
+
+/**
+ * @brief Libera a memória usada pela partida.
+ *
+ * @param p Partida.
+ */
+void partida_fim(Partida *p);
+
+/**
+ * @brief Executa um passo da partida.
+ *
+ * Processa as teclas digitadas, na ordem, cada uma na hora em que chegou, e avança a partida
+ * até a hora dada (surgimento, ativação e expiração de palavras).
+ *
+ * @param p Partida.
+ * @param agora Hora do passo, em segundos desde o início da partida.
+ * @param teclas Teclas digitadas desde o passo anterior.
+ * @param horas Hora em que chegou cada tecla, em segundos desde o início da partida, em ordem
+ *              crescente; se NULL, todas as teclas chegaram agora.
+ * @param n_teclas Número de teclas.
+ * @param oc Onde contar o que aconteceu no passo.
+ */
+void partida_passo(Partida *p, double agora, const char *teclas, const double *horas,
+                   int n_teclas, Ocorrencias *oc);
+
+/**
+ * @brief Verifica se a letra é a próxima a ser digitada na palavra.
+ *
+ * @param reserva Reserva com as palavras.
+ * @param p_sel Índice da palavra selecionada.
+ * @param letra Letra a ser verificada.
+ * @return Retorna true se a letra é a próxima da palavra, false caso contrário.
+ */
+bool acha_letra(const Reserva *reserva, int p_sel, char letra);
+
+/**
+ * @brief Marca a próxima letra da palavra como digitada, em O(1).
+ *
+ * @param reserva Reserva com as palavras.
+ * @param p_sel Índice da palavra selecionada.
+ */
+void remove_pos(Reserva *reserva, int p_sel);
+
+/**
+ * @brief Seleciona uma palavra das palavras e a retira do índice.
+ *
+ * @param indice Índice das palavras disponíveis, por primeira letra.
+ * @param l Letra para determinar a palavra.
+ * @return Índice da palavra selecionada.
+ */
+int seleciona_palavra(IndiceLetras *indice, char l);
+
+/**
+ * @brief Coloca todas as palavras na agenda, com prazo na hora de ativação.
+ *
+ * @param reserva Reserva com as palavras do jogo.
+ * @param agenda Agenda de prazos das palavras.
+ */
+void agenda_palavras(Reserva *reserva, Agenda *agenda);
+
+/**
+ * @brief Coloca no índice as palavras cuja hora de ativação chegou.
+ *
+ * @param p Partida.
+ * @param oc Onde contar as palavras ativadas.
+ */
+void ativa_palavras(Partida *p, Ocorrencias *oc);
+
+/**
+ * @brief Verifica se todas as letras da palavra selecionada foram digitadas.
+ *
+ * @param reserva Reserva com as palavras.
+ * @param p_sel Índice da palavra selecionada.
+ * @return Retorna true se todas as letras foram digitadas, false caso contrário.
+ */
+bool palavra_selecionada_terminou(const Reserva *reserva, int p_sel);
+
+/**
+ * @brief Verifica se o caractere é válido.
+ *
+ * @param l Caractere a ser verificado.
+ * @return Retorna true se o caractere for válido, false caso contrário.
+ */
+bool caractere_valido(char l);
+
+/**
+ * @brief Transforma o caractere maiúsculo em minúsculo, se necessário.
+ *
+ * @param l Caractere a ser convertido.
+ * @return Caractere convertido.
+ */
+char converte_caractere(char l);
+
+/**
+ * @brief Verifica se uma linha do arquivo de palavras pode ser usada no jogo.
+ *
+ * @param palavra Letras da palavra (sem '\0' no final).
+ * @param tam Número de letras.
+ * @return Retorna true se a palavra pode ser usada, false caso contrário.
+ */
+bool palavra_valida(const char *palavra, int tam);
+
+/**
+ * @brief Copia uma palavra do dicionário, em minúsculas, guardando seu tamanho.
+ *
+ * @param reserva Reserva.
+ * @param vaga Vaga a preencher.
+ * @param i Índice da palavra no dicionário.
+ */
+void copia_palavra(Reserva *reserva, int vaga, int i);
+
+/**
+ * @brief Coloca em jogo uma palavra nova, sorteada do dicionário.
+ *
+ * @param p Partida.
+ * @param hora Hora de ativação da palavra.
+ * @return Retorna true se a palavra foi criada, false se não havia vaga ou o dicionário está vazio.
+ */
+bool nasce_palavra(Partida *p, double hora);
+
+/**
+ * @brief Calcula o intervalo até a próxima palavra surgir no modo infinito.
+ *
+ * @param hora Hora em que surgiu a palavra anterior.
+ * @return Intervalo, em segundos.
+ */
+double intervalo_nascimento(double hora);
+
+/**
+ * @brief Faz surgir as palavras do modo infinito cuja hora chegou.
+ *
+ * @param p Partida.
+ */
+void gera_palavras(Partida *p);
+
+/**
+ * @brief Preenche as palavras da reserva com palavras sorteadas.
+ *
+ * @param reserva Reserva com as palavras do jogo.
+ */
+void preenche_palavras(Reserva *reserva);
+
+/**
+ * @brief Define a posição horizontal das palavras.
+ *
+ * @param reserva Reserva com as palavras do jogo.
+ */
+void preenche_pos_horizontal(Reserva *reserva);
+
+/**
+ * @brief Define a hora de ativação das palavras.
+ *
+ * @param reserva Reserva com as palavras do jogo.
+ */
+void preenche_hora_ativacao(Reserva *reserva);
+
+/**
+ * @brief Define o tempo para digitação das palavras.
+ *
+ * @param reserva Reserva com as palavras do jogo.
+ */
+void preenche_tempo_digitacao(Reserva *reserva);
+
+/**
+ * @brief Verifica se a tecla é a correta e age de acordo.
+ *
+ * @param p Partida.
+ * @param letra Tecla digitada.
+ * @param oc Onde contar acertos, erros e palavras completas.
+ */
+void processa_entrada(Partida *p, char letra, Ocorrencias *oc);
+
+/**
+ * @brief Verifica se o tempo de digitação da palavra expirou.
+ *
+ * @param p Partida.
+ * @return Retorna true se o tempo de digitação expirou, false caso contrário.
+ */
+bool tempo_digitacao_expirou(const Partida *p);
+
+#endif /* REGRAS_H */
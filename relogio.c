@@ -0,0 +1,98 @@
+/**
+ * @file relogio.c
+ *
+ * @brief Implementação do relógio da partida.
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#include "relogio.h"
+
+#include <time.h>
+
+/**
+ * @brief Lê a fonte do relógio.
+ *
+ * O relógio monotônico não volta nem pula quando a hora do sistema é ajustada.
+ *
+ * @param r Relógio.
+ * @return Valor da fonte, em segundos.
+ */
+static double relogio_le_fonte(const Relogio *r)
+{
+  if (r->virtual) {
+    return r->fonte;
+  }
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec*1e-9;
+}
+
+/**
+ * @brief Zera os campos do relógio e marca o início.
+ *
+ * @param r Relógio.
+ * @param virtual Se o relógio é virtual.
+ */
+static void relogio_zera(Relogio *r, bool virtual)
+{
+  r->virtual = virtual;
+  r->fonte = 0.0;
+  r->em_pausa = 0.0;
+  r->hora_pausa = 0.0;
+  r->pausado = false;
+  r->agora = 0.0;
+  r->inicio = relogio_le_fonte(r);
+}
+
+void relogio_ini(Relogio *r)
+{
+  relogio_zera(r, false);
+}
+
+void relogio_ini_virtual(Relogio *r)
+{
+  relogio_zera(r, true);
+}
+
+void relogio_avanca(Relogio *r, double segundos)
+{
+  r->fonte += segundos;
+}
+
+void relogio_tique(Relogio *r)
+{
+  if (r->pausado) {
+    return;
+  }
+  r->agora = relogio_le_fonte(r) - r->inicio - r->em_pausa;
+}
+
+double relogio_agora(const Relogio *r)
+{
+  return r->agora;
+}
+
+double relogio_converte(const Relogio *r, double fonte)
+{
+  double hora = fonte - r->inicio - r->em_pausa;
+  return hora < r->agora ? hora : r->agora;
+}
+
+void relogio_pausa(Relogio *r)
+{
+  if (!r->pausado) {
+    relogio_tique(r);
+    r->hora_pausa = relogio_le_fonte(r);
+    r->pausado = true;
+  }
+}
+
+void relogio_retoma(Relogio *r)
+{
+  if (r->pausado) {
+    r->em_pausa += relogio_le_fonte(r) - r->hora_pausa;
+    r->pausado = false;
+    relogio_tique(r);
+  }
+}
@@ -0,0 +1,97 @@
+/**
+ * @file relogio.h
+ *
+ * @brief Definição do relógio da partida.
+ *
+ * O relógio é lido uma vez por tique (a cada volta do laço do jogo) e todas
+ * as funções do jogo usam essa mesma leitura.
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#ifndef RELOGIO_H
+#define RELOGIO_H
+
+#include <stdbool.h>
+
+/**
+ * @brief Relógio da partida.
+ */
+typedef struct {
+  bool virtual;       /**< Se true, o tempo só anda com relogio_avanca. */
+  double fonte;       /**< Valor da fonte, para o relógio virtual. */
+  double inicio;      /**< Valor da fonte quando o relógio foi iniciado. */
+  double em_pausa;    /**< Total de segundos em pausa. */
+  double hora_pausa;  /**< Valor da fonte quando começou a pausa atual. */
+  bool pausado;       /**< Se o relógio está em pausa. */
+  double agora;       /**< Tempo de jogo (em segundos) no último tique. */
+} Relogio;
+
+/**
+ * @brief Inicia o relógio em zero, usando o relógio monotônico do sistema.
+ *
+ * @param r Relógio.
+ */
+void relogio_ini(Relogio *r);
+
+/**
+ * @brief Inicia o relógio em zero, com tempo virtual.
+ *
+ * O tempo do relógio virtual só passa com chamadas a relogio_avanca.
+ *
+ * @param r Relógio.
+ */
+void relogio_ini_virtual(Relogio *r);
+
+/**
+ * @brief Avança o tempo de um relógio virtual.
+ *
+ * @param r Relógio.
+ * @param segundos Quanto tempo passou.
+ */
+void relogio_avanca(Relogio *r, double segundos);
+
+/**
+ * @brief Lê a fonte do relógio e atualiza o tempo de jogo.
+ *
+ * Deve ser chamada uma vez a cada volta do laço do jogo.
+ *
+ * @param r Relógio.
+ */
+void relogio_tique(Relogio *r);
+
+/**
+ * @brief Retorna o tempo de jogo no último tique.
+ *
+ * @param r Relógio.
+ * @return Segundos de jogo (sem contar as pausas) desde o início.
+ */
+double relogio_agora(const Relogio *r);
+
+/**
+ * @brief Converte uma hora lida do relógio monotônico em tempo de jogo.
+ *
+ * Serve para horas marcadas fora do relógio, como a chegada de uma tecla. Pausas
+ * posteriores à hora dada também são descontadas, então ela deve ser recente.
+ *
+ * @param r Relógio.
+ * @param fonte Hora do relógio monotônico (CLOCK_MONOTONIC), em segundos.
+ * @return Segundos de jogo correspondentes, nunca depois do último tique.
+ */
+double relogio_converte(const Relogio *r, double fonte);
+
+/**
+ * @brief Para o relógio; o tempo em pausa não conta como tempo de jogo.
+ *
+ * @param r Relógio.
+ */
+void relogio_pausa(Relogio *r);
+
+/**
+ * @brief Faz o relógio voltar a andar depois de uma pausa.
+ *
+ * @param r Relógio.
+ */
+void relogio_retoma(Relogio *r);
+
+#endif /* RELOGIO_H */
@@ -0,0 +1,85 @@
+/**
+ * @file reserva.c
+ *
+ * @brief Implementação da reserva de palavras do jogo.
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#include "reserva.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+void reserva_ini(Reserva *r, int capacidade)
+{
+  r->capacidade = capacidade;
+  r->n = 0;
+  r->n_livres = capacidade;
+  r->letras = malloc(capacidade * sizeof(*r->letras));
+  r->tam = malloc(capacidade * sizeof(*r->tam));
+  r->digitadas = malloc(capacidade * sizeof(*r->digitadas));
+  r->pos_horizontal = malloc(capacidade * sizeof(int));
+  r->hora_ativacao = malloc(capacidade * sizeof(double));
+  r->tempo_digitacao = malloc(capacidade * sizeof(int));
+  r->ativa = malloc(capacidade * sizeof(bool));
+  r->livres = malloc(capacidade * sizeof(int));
+  r->ocupadas = malloc(capacidade * sizeof(int));
+  r->pos = malloc(capacidade * sizeof(int));
+  if (r->letras == NULL || r->tam == NULL || r->digitadas == NULL || r->pos_horizontal == NULL
+      || r->hora_ativacao == NULL || r->tempo_digitacao == NULL || r->ativa == NULL
+      || r->livres == NULL || r->ocupadas == NULL || r->pos == NULL) {
+    perror("Sem memória para as palavras");
+    exit(1);
+  }
+  // as vagas de número menor saem primeiro
+  for (int i = 0; i < capacidade; i++) {
+    r->livres[i] = capacidade - 1 - i;
+    r->pos[i] = -1;
+  }
+}
+
+void reserva_fim(Reserva *r)
+{
+  free(r->letras);
+  free(r->tam);
+  free(r->digitadas);
+  free(r->pos_horizontal);
+  free(r->hora_ativacao);
+  free(r->tempo_digitacao);
+  free(r->ativa);
+  free(r->livres);
+  free(r->ocupadas);
+  free(r->pos);
+  r->letras = NULL;
+  r->tam = r->digitadas = NULL;
+  r->pos_horizontal = r->tempo_digitacao = NULL;
+  r->hora_ativacao = NULL;
+  r->ativa = NULL;
+  r->livres = r->ocupadas = r->pos = NULL;
+  r->n = r->n_livres = r->capacidade = 0;
+}
+
+int reserva_pega(Reserva *r)
+{
+  if (r->n_livres == 0) {
+    return -1;
+  }
+  int vaga = r->livres[--r->n_livres];
+  r->pos[vaga] = r->n;
+  r->ocupadas[r->n++] = vaga;
+  return vaga;
+}
+
+void reserva_devolve(Reserva *r, int vaga)
+{
+  int i = r->pos[vaga];
+  if (i == -1) {
+    return;
+  }
+  int ultima = r->ocupadas[--r->n];
+  r->ocupadas[i] = ultima;
+  r->pos[ultima] = i;
+  r->pos[vaga] = -1;
+  r->livres[r->n_livres++] = vaga;
+}
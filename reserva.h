@@ -0,0 +1,79 @@
+/**
+ * @file reserva.h
+ *
+ * @brief Definição da reserva de palavras do jogo.
+ *
+ * A reserva tem um número fixo de vagas, escolhido ao criá-la. Cada palavra
+ * em jogo ocupa uma vaga, e o número da vaga não muda enquanto a palavra
+ * estiver em jogo; por isso ele pode ser guardado no índice, na agenda e
+ * como palavra selecionada. Pegar e devolver vagas custa O(1).
+ *
+ * Os dados das palavras ficam em vetores separados, um por campo, indexados
+ * pela vaga: quem percorre as palavras lê só os campos que usa. As letras de
+ * uma palavra não mudam enquanto ela está em jogo; digitar uma letra só avança
+ * o cursor de letras digitadas.
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#ifndef RESERVA_H
+#define RESERVA_H
+
+#include <stdbool.h>
+
+#define N_LETRA 16   /**< Número de letras a serem geradas. */
+
+/**
+ * @brief Reserva de palavras.
+ */
+typedef struct {
+  char (*letras)[N_LETRA];  /**< Letras da palavra de cada vaga, terminadas em '\0'. */
+  unsigned char *tam;       /**< Número de letras da palavra de cada vaga. */
+  unsigned char *digitadas; /**< Número de letras já digitadas da palavra de cada vaga. */
+  int *pos_horizontal;      /**< Posição horizontal da palavra na tela (0 a 100). */
+  double *hora_ativacao;    /**< Hora em que a palavra foi ativada. */
+  int *tempo_digitacao;     /**< Tempo permitido para a digitação da palavra. */
+  bool *ativa;              /**< Se a hora de ativação já chegou. */
+  int *livres;        /**< Pilha de vagas livres. */
+  int n_livres;       /**< Número de vagas livres. */
+  int *ocupadas;      /**< Vagas ocupadas, sem buracos entre elas. */
+  int *pos;           /**< Posição de cada vaga em ocupadas, ou -1 se livre. */
+  int n;              /**< Número de vagas ocupadas. */
+  int capacidade;     /**< Número total de vagas. */
+} Reserva;
+
+/**
+ * @brief Cria uma reserva com todas as vagas livres.
+ *
+ * @param r Reserva.
+ * @param capacidade Número de vagas.
+ */
+void reserva_ini(Reserva *r, int capacidade);
+
+/**
+ * @brief Libera a memória da reserva.
+ *
+ * @param r Reserva.
+ */
+void reserva_fim(Reserva *r);
+
+/**
+ * @brief Ocupa uma vaga livre.
+ *
+ * @param r Reserva.
+ * @return Número da vaga, ou -1 se não houver vaga livre.
+ */
+int reserva_pega(Reserva *r);
+
+/**
+ * @brief Libera uma vaga ocupada.
+ *
+ * A última vaga de ocupadas passa para o lugar da liberada; os números
+ * das vagas não mudam.
+ *
+ * @param r Reserva.
+ * @param vaga Número da vaga.
+ */
+void reserva_devolve(Reserva *r, int vaga);
+
+#endif /* RESERVA_H */
@@ -0,0 +1,73 @@
+/**
+ * @file ritmo.c
+ *
+ * @brief Implementação do controle do ritmo de quadros.
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#include "ritmo.h"
+
+void ritmo_ini(Ritmo *r, int fps, double agora, long bytes)
+{
+  r->fps_max = fps < RITMO_MINIMO ? RITMO_MINIMO : fps;
+  r->fps = r->fps_max;
+  r->proximo = agora;
+  r->inicio_janela = agora;
+  r->bytes_janela = bytes;
+  r->quadros = 0;
+  r->atrasados = 0;
+  r->tempo_desenho = 0.0;
+}
+
+bool ritmo_pode_desenhar(const Ritmo *r, double agora)
+{
+  // os quadros vêm do temporizador, que dispara fps_max vezes por segundo;
+  //   a folga evita perder um disparo que chegou um pouco antes da hora
+  return agora >= r->proximo - 0.5 / r->fps_max;
+}
+
+// revê o ritmo com o que aconteceu na janela que terminou
+static void revisa(Ritmo *r, double agora, long bytes)
+{
+  double duracao = agora - r->inicio_janela;
+  double intervalo = 1.0 / r->fps;
+  int fps = r->fps;
+  if (r->atrasados > 0) {
+    // o terminal não escoou os quadros: cai para o que ele escoou, e no
+    //   máximo para a metade
+    double por_quadro = r->quadros > 0 ? (double)(bytes - r->bytes_janela) / r->quadros : 0;
+    double taxa = (bytes - r->bytes_janela) / duracao;
+    fps = fps / 2;
+    if (por_quadro > 0 && taxa / por_quadro < fps) {
+      fps = taxa / por_quadro;
+    }
+  } else if (r->tempo_desenho / r->quadros > RITMO_ORCAMENTO * intervalo) {
+    fps = fps / 2;
+  } else if (r->tempo_desenho / r->quadros < RITMO_ORCAMENTO / 2 * intervalo) {
+    fps = fps + fps / 4 + 1;
+  }
+  if (fps < RITMO_MINIMO) {
+    fps = RITMO_MINIMO;
+  }
+  if (fps > r->fps_max) {
+    fps = r->fps_max;
+  }
+  r->fps = fps;
+  r->inicio_janela = agora;
+  r->bytes_janela = bytes;
+  r->quadros = 0;
+  r->atrasados = 0;
+  r->tempo_desenho = 0.0;
+}
+
+void ritmo_desenhou(Ritmo *r, double inicio, double fim, long bytes, bool atrasado)
+{
+  r->quadros++;
+  r->atrasados += atrasado;
+  r->tempo_desenho += fim - inicio;
+  if (fim - r->inicio_janela >= RITMO_JANELA) {
+    revisa(r, fim, bytes);
+  }
+  r->proximo = inicio + 1.0 / r->fps;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file ritmo.h
+ *
+ * @brief Definição do controle do ritmo de quadros.
+ *
+ * As regras do jogo avançam a cada disparo do temporizador, mas a tela só é
+ * desenhada no ritmo que o terminal e o processador aguentam. A cada janela
+ * de RITMO_JANELA segundos o ritmo é revisto: se o terminal ficou atrasado
+ * (quadros retidos esperando a saída) ou se desenhar tomou mais que
+ * RITMO_ORCAMENTO do intervalo entre quadros, o ritmo cai pela metade, ou para
+ * o que a saída conseguiu escoar; se não, sobe aos poucos até o pedido.
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#ifndef RITMO_H
+#define RITMO_H
+
+#include <stdbool.h>
+
+#define RITMO_JANELA 0.5     /**< Segundos entre as revisões do ritmo. */
+#define RITMO_MINIMO 4       /**< Menor número de quadros por segundo. */
+#define RITMO_ORCAMENTO 0.5  /**< Fração do intervalo entre quadros que o desenho pode usar. */
+
+/**
+ * @brief Estado do controle do ritmo de quadros.
+ */
+typedef struct {
+  int fps_max;            /**< Quadros por segundo pedidos. */
+  int fps;                /**< Quadros por segundo atuais. */
+  double proximo;         /**< Hora a partir da qual o próximo quadro pode ser desenhado. */
+  double inicio_janela;   /**< Hora do início da janela atual. */
+  long bytes_janela;      /**< Bytes já enviados ao terminal no início da janela. */
+  int quadros;            /**< Quadros desenhados na janela. */
+  int atrasados;          /**< Quadros que encontraram o terminal atrasado. */
+  double tempo_desenho;   /**< Tempo gasto desenhando na janela, em segundos. */
+} Ritmo;
+
+/**
+ * @brief Inicia o controle do ritmo no ritmo pedido.
+ *
+ * @param r Controle do ritmo.
+ * @param fps Quadros por segundo pedidos (o máximo).
+ * @param agora Hora atual (relógio monotônico, em segundos).
+ * @param bytes Total de bytes enviados ao terminal até agora.
+ */
+void ritmo_ini(Ritmo *r, int fps, double agora, long bytes);
+
+/**
+ * @brief Diz se já é hora de desenhar um quadro.
+ *
+ * @param r Controle do ritmo.
+ * @param agora Hora atual (relógio monotônico, em segundos).
+ * @return true se o intervalo desde o último quadro já passou.
+ */
+bool ritmo_pode_desenhar(const Ritmo *r, double agora);
+
+/**
+ * @brief Registra um quadro desenhado, e revê o ritmo no fim da janela.
+ *
+ * @param r Controle do ritmo.
+ * @param inicio Hora em que o desenho começou (relógio monotônico, em segundos).
+ * @param fim Hora em que o desenho terminou.
+ * @param bytes Total de bytes enviados ao terminal até agora.
+ * @param atrasado Se o terminal ficou com dados ou quadro retidos.
+ */
+void ritmo_desenhou(Ritmo *r, double inicio, double fim, long bytes, bool atrasado);
+
+#endif /* RITMO_H */
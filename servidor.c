@@ -0,0 +1,627 @@
+/**
+ * @file servidor.c
+ *
+ * @brief Implementação do servidor de partidas e de seus clientes.
+ *
+ * O servidor espera em epoll por conexões, teclas e pelo temporizador de
+ * quadros. A cada quadro, todas as partidas avançam com as teclas recebidas
+ * desde o quadro anterior (com as mesmas regras de jogo()), e as telas que
+ * mudaram são desenhadas com desenha_tela(), cada uma em sua tela em memória.
+ * Os quadros são enviados sem bloquear: enquanto um cliente não recebeu o
+ * quadro anterior, sua tela não é redesenhada, e ele recebe o estado mais
+ * recente quando conseguir.
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#define _GNU_SOURCE // accept4
+
+#include "servidor.h"
+#include "simulacao.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#define N_EVENTOS 256 /**< Eventos tratados por chamada a epoll_wait. */
+
+/**
+ * @brief Um jogador conectado ao servidor.
+ */
+typedef struct {
+  int fd;                                /**< Conexão com o cliente. */
+  int indice;                            /**< Posição no vetor de conexões. */
+  bool apresentado;                      /**< Se o cliente já informou o tamanho da tela. */
+  char entrada[SERVIDOR_N_ENTRADA];      /**< Bytes recebidos desde o último quadro. */
+  int n_entrada;                         /**< Número de bytes em entrada. */
+  tela_t *tela;                          /**< Tela do cliente. */
+  Partida partida;                       /**< Partida do cliente. */
+  Relogio relogio;                       /**< Relógio da partida. */
+  bool em_jogo;                          /**< Se a partida está em andamento (senão, mostra o resultado). */
+  bool redesenha;                        /**< Se a tela mudou desde o último quadro desenhado. */
+  double proxima_mudanca;                /**< Hora da partida em que o último quadro desenhado muda sozinho. */
+  bool fechar;                           /**< Se a conexão deve ser fechada no fim da volta do laço. */
+} Conexao;
+
+// conexões abertas
+static Conexao **conexoes;
+static int n_conexoes, cap_conexoes;
+
+// marcadores dos descritores que não são de conexões, para epoll
+static int marca_escuta, marca_quadro, marca_sinal;
+
+// aumenta o limite de descritores abertos até o máximo permitido
+static void aumenta_limite_descritores(void)
+{
+  struct rlimit r;
+  if (getrlimit(RLIMIT_NOFILE, &r) == 0 && r.rlim_cur < r.rlim_max) {
+    r.rlim_cur = r.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &r);
+  }
+}
+
+// preenche o endereço do socket; retorna false se o nome for longo demais
+static bool endereco(struct sockaddr_un *end, const char *nome)
+{
+  memset(end, 0, sizeof(*end));
+  end->sun_family = AF_UNIX;
+  if (strlen(nome) >= sizeof(end->sun_path)) {
+    fprintf(stderr, "Nome de socket longo demais: %s\n", nome);
+    return false;
+  }
+  strcpy(end->sun_path, nome);
+  return true;
+}
+
+// diz se o socket de end pode ser removido para o servidor usá-lo: ele não
+//   existe, ou existe mas nenhum servidor está esperando nele (sobrou de um
+//   servidor que não terminou direito)
+static bool endereco_livre(const struct sockaddr_un *end)
+{
+  struct stat st;
+  if (stat(end->sun_path, &st) != 0) {
+    return errno == ENOENT;
+  }
+  if (!S_ISSOCK(st.st_mode)) {
+    return false; // não é um socket: não é para apagar
+  }
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd == -1) {
+    return false;
+  }
+  bool livre = connect(fd, (const struct sockaddr *)end, sizeof(*end)) != 0
+            && errno == ECONNREFUSED;
+  close(fd);
+  return livre;
+}
+
+// começa uma nova partida na conexão
+static void nova_partida(Conexao *c, const Opcoes *opcoes)
+{
+  partida_ini(&c->partida, opcoes->n_palavras, opcoes->infinito);
+  relogio_ini(&c->relogio);
+  c->em_jogo = true;
+  c->redesenha = true;
+  c->proxima_mudanca = 0.0;
+}
+
+// desenha o resultado da partida terminada
+static void desenha_fim(const Conexao *c)
+{
+  tela_limpa();
+  int lin = tela_nlin() / 2 - 3;
+  int col = tela_ncol() / 2 - 30/2;
+  tela_lincol(lin, col);
+  if (c->partida.reserva.n <= 0 && !c->partida.infinito) {
+    tela_cor_letra(250, 250, 30);
+    tela_escreve("PARABÉNS!! VOCÊ VENCEU!!!");
+  } else {
+    tela_cor_letra(230, 10, 10);
+    tela_escreve("FIM DE JOGO!!!");
+  }
+  tela_lincol(++lin, col);
+  tela_escreve("TOTAL:  %d PONTOS", c->partida.pontos);
+  tela_cor_letra(0, 240, 0);
+  tela_lincol(++lin, col);
+  tela_escreve("Tecle <enter> para jogar de novo ou 'q' para sair");
+  tela_cor_normal();
+  tela_atualiza();
+}
+
+// fecha a conexão e libera tudo o que ela usa
+static void remove_conexao(Conexao *c)
+{
+  close(c->fd);
+  if (c->apresentado) {
+    partida_fim(&c->partida);
+    tela_destroi(c->tela);
+  }
+  // o último ocupa o lugar do removido
+  Conexao *ultima = conexoes[--n_conexoes];
+  conexoes[c->indice] = ultima;
+  ultima->indice = c->indice;
+  free(c);
+}
+
+// aceita todas as conexões pendentes
+static void aceita(int escuta, int ep)
+{
+  for (;;) {
+    int fd = accept4(escuta, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd == -1) {
+      return;
+    }
+    Conexao *c = calloc(1, sizeof(Conexao));
+    if (c == NULL) {
+      close(fd);
+      continue;
+    }
+    if (n_conexoes == cap_conexoes) {
+      int cap = cap_conexoes == 0 ? 64 : 2 * cap_conexoes;
+      Conexao **novo = realloc(conexoes, cap * sizeof(Conexao *));
+      if (novo == NULL) {
+        close(fd);
+        free(c);
+        continue;
+      }
+      conexoes = novo;
+      cap_conexoes = cap;
+    }
+    c->fd = fd;
+    c->indice = n_conexoes;
+    conexoes[n_conexoes++] = c;
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = c };
+    if (epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev) != 0) {
+      // ainda não há eventos desta conexão: pode ser fechada já
+      remove_conexao(c);
+    }
+  }
+}
+
+// trata a linha de apresentação ("linhas colunas\n"); retorna false se
+//   ela for inválida
+static bool apresenta(Conexao *c, const Opcoes *opcoes)
+{
+  char *fim = memchr(c->entrada, '\n', c->n_entrada);
+  if (fim == NULL) {
+    // a linha ainda não chegou inteira
+    return c->n_entrada < SERVIDOR_N_ENTRADA;
+  }
+  *fim = '\0';
+  int nlin, ncol;
+  if (sscanf(c->entrada, "%d %d", &nlin, &ncol) != 2) {
+    return false;
+  }
+  if (nlin < SERVIDOR_MIN_LIN) nlin = SERVIDOR_MIN_LIN;
+  if (nlin > SERVIDOR_MAX_LIN) nlin = SERVIDOR_MAX_LIN;
+  if (ncol < SERVIDOR_MIN_COL) ncol = SERVIDOR_MIN_COL;
+  if (ncol > SERVIDOR_MAX_COL) ncol = SERVIDOR_MAX_COL;
+  c->tela = tela_cria(nlin, ncol);
+  if (c->tela == NULL) {
+    return false;
+  }
+  c->apresentado = true;
+  // o que veio depois da linha já são teclas
+  int resto = c->n_entrada - (fim + 1 - c->entrada);
+  memmove(c->entrada, fim + 1, resto);
+  c->n_entrada = resto;
+  nova_partida(c, opcoes);
+  return true;
+}
+
+// lê o que o cliente enviou; retorna false se a conexão acabou
+static bool recebe(Conexao *c, const Opcoes *opcoes)
+{
+  char buf[512];
+  for (;;) {
+    ssize_t n = read(c->fd, buf, sizeof(buf));
+    if (n == 0) {
+      return false;
+    }
+    if (n < 0) {
+      return errno == EAGAIN || errno == EINTR;
+    }
+    // teclas além do que cabe até o próximo quadro são descartadas
+    int cabe = SERVIDOR_N_ENTRADA - c->n_entrada;
+    if (n > cabe) {
+      n = cabe;
+    }
+    memcpy(c->entrada + c->n_entrada, buf, n);
+    c->n_entrada += n;
+    if (!c->apresentado && !apresenta(c, opcoes)) {
+      return false;
+    }
+  }
+}
+
+// envia o que for possível dos quadros pendentes; retorna false se a
+//   conexão acabou
+static bool entrega(Conexao *c)
+{
+  tela_seleciona(c->tela);
+  int n;
+  const char *bytes = tela_pendente(&n);
+  bool ok = true;
+  if (n > 0) {
+    ssize_t enviados = send(c->fd, bytes, n, MSG_NOSIGNAL);
+    if (enviados > 0) {
+      tela_entregue(enviados);
+    } else if (enviados < 0 && errno != EAGAIN && errno != EINTR) {
+      ok = false;
+    }
+  }
+  tela_seleciona(NULL);
+  return ok;
+}
+
+// avança a partida da conexão até agora e desenha sua tela, se mudou;
+//   retorna false se a conexão deve ser fechada
+static bool quadro(Conexao *c, const Opcoes *opcoes)
+{
+  if (!c->apresentado) {
+    return true;
+  }
+  if (c->em_jogo) {
+    relogio_tique(&c->relogio);
+    long hora = relogio_agora(&c->relogio) * 1e6;
+    Ocorrencias oc;
+    partida_passo(&c->partida, hora * 1e-6, c->entrada, NULL, c->n_entrada, &oc);
+    if (oc.ativadas + oc.acertos + oc.erros + oc.completas > 0 || oc.fim
+        || c->partida.agora >= c->proxima_mudanca) {
+      c->redesenha = true;
+    }
+    if (oc.fim) {
+      c->em_jogo = false;
+    }
+  } else {
+    for (int i = 0; i < c->n_entrada; i++) {
+      if (c->entrada[i] == 'q' || c->entrada[i] == 'Q') {
+        return false;
+      }
+      if (c->entrada[i] == '\n' || c->entrada[i] == '\r') {
+        partida_fim(&c->partida);
+        nova_partida(c, opcoes);
+        break;
+      }
+    }
+  }
+  c->n_entrada = 0;
+
+  // só desenha quando o quadro anterior já foi entregue
+  int pendente;
+  tela_seleciona(c->tela);
+  tela_pendente(&pendente);
+  if (c->redesenha && pendente == 0) {
+    if (c->em_jogo) {
+      c->proxima_mudanca = desenha_tela(&c->partida);
+    } else {
+      desenha_fim(c);
+    }
+    c->redesenha = false;
+  }
+  tela_seleciona(NULL);
+  return entrega(c);
+}
+
+bool servidor(const Opcoes *opcoes)
+{
+  aumenta_limite_descritores();
+  struct sockaddr_un end;
+  if (!endereco(&end, opcoes->servidor)) {
+    return false;
+  }
+  // só remove o socket que ficou de um servidor que já terminou: com um
+  //   servidor rodando nele, bind falha e este não começa
+  if (!endereco_livre(&end)) {
+    fprintf(stderr, "O socket %s está em uso (ou não é um socket)\n", opcoes->servidor);
+    return false;
+  }
+  int escuta = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  unlink(opcoes->servidor);
+  if (escuta == -1 || bind(escuta, (struct sockaddr *)&end, sizeof(end)) != 0
+      || listen(escuta, SOMAXCONN) != 0) {
+    perror("Erro ao criar o socket do servidor");
+    return false;
+  }
+  // SIGINT e SIGTERM chegam pelo signalfd e encerram o laço, para que as
+  //   conexões sejam fechadas e o socket removido
+  sigset_t sinais, mascara_anterior;
+  sigemptyset(&sinais);
+  sigaddset(&sinais, SIGINT);
+  sigaddset(&sinais, SIGTERM);
+  sigprocmask(SIG_BLOCK, &sinais, &mascara_anterior);
+  int fd_sinal = signalfd(-1, &sinais, SFD_NONBLOCK | SFD_CLOEXEC);
+  int ep = epoll_create1(EPOLL_CLOEXEC);
+  int fd_quadro = evento_temporizador(opcoes->fps);
+  struct epoll_event ev = { .events = EPOLLIN, .data.ptr = &marca_escuta };
+  epoll_ctl(ep, EPOLL_CTL_ADD, escuta, &ev);
+  ev.data.ptr = &marca_quadro;
+  epoll_ctl(ep, EPOLL_CTL_ADD, fd_quadro, &ev);
+  ev.data.ptr = &marca_sinal;
+  epoll_ctl(ep, EPOLL_CTL_ADD, fd_sinal, &ev);
+  fprintf(stderr, "Servidor esperando jogadores em %s\n", opcoes->servidor);
+
+  struct epoll_event eventos[N_EVENTOS];
+  bool ok = true;
+  bool parar = false;
+  while (!parar) {
+    int n = epoll_wait(ep, eventos, N_EVENTOS, -1);
+    if (n < 0 && errno != EINTR) {
+      perror("Erro ao esperar eventos");
+      ok = false;
+      break;
+    }
+    // as conexões são só marcadas para fechar, e fechadas no fim da volta:
+    //   outros eventos desta volta podem ser delas
+    bool fechou = false;
+    for (int i = 0; i < n; i++) {
+      void *marca = eventos[i].data.ptr;
+      if (marca == &marca_sinal) {
+        // o sinal é consumido aqui, para não ser entregue quando for desbloqueado
+        struct signalfd_siginfo info;
+        if (read(fd_sinal, &info, sizeof(info)) == sizeof(info)) {
+          parar = true;
+        }
+      } else if (marca == &marca_escuta) {
+        aceita(escuta, ep);
+      } else if (marca == &marca_quadro) {
+        uint64_t disparos;
+        if (read(fd_quadro, &disparos, sizeof(disparos)) == sizeof(disparos)) {
+          for (int j = 0; j < n_conexoes; j++) {
+            Conexao *c = conexoes[j];
+            if (!c->fechar && !quadro(c, opcoes)) {
+              c->fechar = fechou = true;
+            }
+          }
+        }
+      } else {
+        Conexao *c = marca;
+        if (!c->fechar && !recebe(c, opcoes)) {
+          c->fechar = fechou = true;
+        }
+      }
+    }
+    // de trás para frente, pois uma conexão removida é trocada pela última
+    for (int j = n_conexoes - 1; fechou && j >= 0; j--) {
+      if (conexoes[j]->fechar) {
+        remove_conexao(conexoes[j]);
+      }
+    }
+  }
+  while (n_conexoes > 0) {
+    remove_conexao(conexoes[n_conexoes - 1]);
+  }
+  close(fd_quadro);
+  close(fd_sinal);
+  close(ep);
+  close(escuta);
+  unlink(opcoes->servidor);
+  sigprocmask(SIG_SETMASK, &mascara_anterior, NULL);
+  fprintf(stderr, "Servidor encerrado\n");
+  return ok;
+}
+
+// conecta ao servidor; retorna o descritor, ou -1 em caso de erro
+static int conecta(const char *nome)
+{
+  struct sockaddr_un end;
+  if (!endereco(&end, nome)) {
+    return -1;
+  }
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd != -1 && connect(fd, (struct sockaddr *)&end, sizeof(end)) != 0) {
+    close(fd);
+    fd = -1;
+  }
+  return fd;
+}
+
+// envia todos os bytes, esperando se preciso; retorna false em caso de erro
+static bool envia_tudo(int fd, const char *bytes, int n)
+{
+  while (n > 0) {
+    ssize_t enviados = send(fd, bytes, n, MSG_NOSIGNAL);
+    if (enviados < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    bytes += enviados;
+    n -= enviados;
+  }
+  return true;
+}
+
+bool cliente(const Opcoes *opcoes)
+{
+  int fd = conecta(opcoes->cliente);
+  if (fd == -1) {
+    perror("Erro ao conectar ao servidor");
+    return false;
+  }
+  tela_ini();
+  tecla_ini();
+  // envia já a troca para a tela alternativa, antes dos quadros do servidor
+  tela_atualiza();
+  char apresentacao[32];
+  int n = snprintf(apresentacao, sizeof(apresentacao), "%d %d\n", tela_nlin(), tela_ncol());
+  bool ok = envia_tudo(fd, apresentacao, n);
+
+  // o servidor desenha a tela; o cliente só repassa teclas e quadros
+  struct pollfd fds[2] = {
+    { .fd = tecla_descritor(), .events = POLLIN },
+    { .fd = fd, .events = POLLIN },
+  };
+  while (ok) {
+    if (poll(fds, 2, -1) < 0) {
+      ok = errno == EINTR;
+      continue;
+    }
+    if (fds[0].revents != 0) {
+      char teclas[TECLA_N_BYTES];
+      int n_teclas = tecla_le_teclas(teclas, TECLA_N_BYTES);
+      if (n_teclas < 0) {
+        break; // o teclado foi fechado
+      }
+      if (n_teclas > 0) {
+        ok = envia_tudo(fd, teclas, n_teclas);
+      }
+    }
+    if (fds[1].revents & (POLLIN | POLLHUP)) {
+      char buf[4096];
+      ssize_t lidos = read(fd, buf, sizeof(buf));
+      if (lidos == 0) {
+        break; // o servidor encerrou a sessão
+      }
+      if (lidos < 0) {
+        ok = errno == EINTR;
+        continue;
+      }
+      for (ssize_t escritos = 0; ok && escritos < lidos; ) {
+        ssize_t e = write(1, buf + escritos, lidos - escritos);
+        if (e < 0 && errno != EINTR) {
+          ok = false;
+        }
+        escritos += e > 0 ? e : 0;
+      }
+    }
+  }
+  close(fd);
+  tecla_fim();
+  // o conteúdo da tela foi desenhado pelo servidor
+  tela_invalida();
+  tela_fim();
+  return ok;
+}
+
+/**
+ * @brief Uma sessão aberta pelo gerador de carga.
+ */
+typedef struct {
+  int fd;               /**< Conexão com o servidor. */
+  double proxima;       /**< Hora de enviar a próxima tecla. */
+  double enviada;       /**< Hora em que foi enviada a tecla ainda sem resposta, ou 0. */
+  bool aberta;          /**< Se a conexão ainda está aberta. */
+} SessaoCarga;
+
+bool carga(const Opcoes *opcoes)
+{
+  aumenta_limite_descritores();
+  int n = opcoes->sessoes;
+  SessaoCarga *sessoes = calloc(n, sizeof(SessaoCarga));
+  int ep = epoll_create1(EPOLL_CLOEXEC);
+  if (sessoes == NULL || ep == -1) {
+    perror("Erro ao preparar as sessões");
+    free(sessoes);
+    return false;
+  }
+
+  // as sessões digitam TECLAS_POR_SEGUNDO teclas por segundo, defasadas
+  //   entre si; de vez em quando um <enter>, para recomeçar as partidas que
+  //   terminaram
+  double inicio = tela_relogio();
+  int abertas = 0;
+  for (int i = 0; i < n; i++) {
+    SessaoCarga *s = &sessoes[i];
+    s->fd = conecta(opcoes->carga);
+    if (s->fd == -1) {
+      continue;
+    }
+    fcntl(s->fd, F_SETFL, O_NONBLOCK);
+    if (!envia_tudo(s->fd, "24 80\n", 6)) {
+      close(s->fd);
+      continue;
+    }
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = s };
+    epoll_ctl(ep, EPOLL_CTL_ADD, s->fd, &ev);
+    s->aberta = true;
+    s->proxima = inicio + (double)i / n / TECLAS_POR_SEGUNDO;
+    abertas++;
+  }
+  if (abertas == 0) {
+    fprintf(stderr, "Nenhuma sessão foi aberta em %s\n", opcoes->carga);
+    free(sessoes);
+    close(ep);
+    return false;
+  }
+
+  Latencias lat;
+  latencia_zera(&lat);
+  long teclas = 0, bytes = 0;
+  int fechadas = 0;
+  int fd_tique = evento_temporizador(1000);
+  struct epoll_event ev = { .events = EPOLLIN, .data.ptr = NULL };
+  epoll_ctl(ep, EPOLL_CTL_ADD, fd_tique, &ev);
+  double fim = inicio + opcoes->duracao;
+  struct epoll_event eventos[N_EVENTOS];
+  double agora = inicio;
+  while (agora < fim) {
+    int ne = epoll_wait(ep, eventos, N_EVENTOS, -1);
+    agora = tela_relogio();
+    for (int i = 0; i < ne; i++) {
+      SessaoCarga *s = eventos[i].data.ptr;
+      if (s == NULL) {
+        uint64_t disparos;
+        if (read(fd_tique, &disparos, sizeof(disparos)) != sizeof(disparos)) {
+          continue;
+        }
+        for (int j = 0; j < n; j++) {
+          SessaoCarga *sj = &sessoes[j];
+          if (!sj->aberta || agora < sj->proxima) {
+            continue;
+          }
+          char tecla = rand() % 20 == 0 ? '\n' : 'a' + rand() % INDICE_N_LETRAS;
+          if (send(sj->fd, &tecla, 1, MSG_NOSIGNAL) == 1) {
+            teclas++;
+            if (sj->enviada == 0) {
+              sj->enviada = agora;
+            }
+          }
+          sj->proxima += 1.0 / TECLAS_POR_SEGUNDO;
+        }
+        continue;
+      }
+      char buf[16384];
+      ssize_t lidos;
+      while ((lidos = read(s->fd, buf, sizeof(buf))) > 0) {
+        bytes += lidos;
+        if (s->enviada != 0) {
+          latencia_registra(&lat, agora - s->enviada);
+          s->enviada = 0;
+        }
+      }
+      if (lidos == 0 || (errno != EAGAIN && errno != EINTR)) {
+        close(s->fd);
+        s->aberta = false;
+        fechadas++;
+      }
+    }
+  }
+  close(fd_tique);
+  for (int i = 0; i < n; i++) {
+    if (sessoes[i].aberta) {
+      close(sessoes[i].fd);
+    }
+  }
+  close(ep);
+  free(sessoes);
+
+  double segundos = agora - inicio;
+  printf("sessões: %d abertas de %d (%d fechadas pelo servidor)\n", abertas, n, fechadas);
+  printf("teclas: %ld (%.0f por segundo)\n", teclas, teclas / segundos);
+  printf("recebidos: %ld bytes (%.0f por segundo)\n", bytes, bytes / segundos);
+  printf("resposta: p50 %.3f ms, p99 %.3f ms, máx %.3f ms\n",
+         latencia_percentil(&lat, 50) * 1e3, latencia_percentil(&lat, 99) * 1e3,
+         latencia_max(&lat) * 1e3);
+  return true;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file servidor.h
+ *
+ * @brief Definição do servidor de partidas e de seus clientes.
+ *
+ * Um único processo hospeda as partidas de muitos jogadores, que se conectam
+ * por um socket Unix. Cada conexão tem sua partida, seu relógio e sua tela.
+ *
+ * Protocolo: o cliente envia uma linha com o tamanho do seu terminal
+ * ("linhas colunas\n") e depois as teclas digitadas, sem modificação. O
+ * servidor envia os quadros da tela, como sequências para o terminal.
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#ifndef SERVIDOR_H
+#define SERVIDOR_H
+
+#include "funcoes.h"
+
+// definições de constantes
+#define SERVIDOR_N_ENTRADA 64 /**< Teclas guardadas por conexão entre dois quadros; as demais são descartadas. */
+#define SERVIDOR_MIN_LIN 16 /**< Menor número de linhas aceito para a tela de um cliente. */
+#define SERVIDOR_MIN_COL 21 /**< Menor número de colunas aceito para a tela de um cliente. */
+#define SERVIDOR_MAX_LIN 200 /**< Maior número de linhas aceito para a tela de um cliente. */
+#define SERVIDOR_MAX_COL 400 /**< Maior número de colunas aceito para a tela de um cliente. */
+#define SESSOES_PADRAO 100 /**< Conexões abertas pelo gerador de carga, se não for escolhido outro valor. */
+#define DURACAO_PADRAO 10 /**< Segundos de execução do gerador de carga, se não for escolhido outro valor. */
+
+// definições de funções
+
+/**
+ * @brief Executa o servidor de partidas, até receber SIGINT ou SIGTERM.
+ *
+ * Não começa se outro servidor já estiver esperando no mesmo socket. Ao terminar, fecha
+ * as conexões e remove o socket.
+ *
+ * @param opcoes Opções escolhidas na linha de comando (socket, fps e regras das partidas).
+ * @return Retorna false se o servidor não pôde ser iniciado ou terminou por erro.
+ */
+bool servidor(const Opcoes *opcoes);
+
+/**
+ * @brief Joga uma sessão no servidor, usando o terminal.
+ *
+ * @param opcoes Opções escolhidas na linha de comando (socket).
+ * @return Retorna false se não foi possível conectar ao servidor.
+ */
+bool cliente(const Opcoes *opcoes);
+
+/**
+ * @brief Abre muitas sessões no servidor, digitando teclas ao acaso, e mede as respostas.
+ *
+ * @param opcoes Opções escolhidas na linha de comando (socket, número de sessões e duração).
+ * @return Retorna false se nenhuma sessão pôde ser aberta.
+ */
+bool carga(const Opcoes *opcoes);
+
+#endif /* SERVIDOR_H */
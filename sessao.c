@@ -0,0 +1,121 @@
+/**
+ * @file sessao.c
+ *
+ * @brief Implementação do registro de sessões de jogo.
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#include "sessao.h"
+
+#include <string.h>
+
+// grava um número sem sinal em varint
+static void grava_varint(FILE *arquivo, unsigned long v)
+{
+  while (v >= 0x80) {
+    fputc((v & 0x7f) | 0x80, arquivo);
+    v >>= 7;
+  }
+  fputc(v, arquivo);
+}
+
+// lê um número gravado em varint; retorna false no fim do arquivo ou se
+//   o número não cabe em um unsigned long
+static bool le_varint(FILE *arquivo, unsigned long *v)
+{
+  *v = 0;
+  for (int desloc = 0; desloc < 64; desloc += 7) {
+    int c = fgetc(arquivo);
+    if (c == EOF) {
+      return false;
+    }
+    *v |= (unsigned long)(c & 0x7f) << desloc;
+    if ((c & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool sessao_grava(Sessao *s, const char *nome, const CabecalhoSessao *cab)
+{
+  s->arquivo = fopen(nome, "wb");
+  if (s->arquivo == NULL) {
+    return false;
+  }
+  s->hora = 0;
+  fputs(SESSAO_MAGICO, s->arquivo);
+  fputc(SESSAO_VERSAO, s->arquivo);
+  grava_varint(s->arquivo, cab->semente);
+  grava_varint(s->arquivo, cab->n_validas);
+  grava_varint(s->arquivo, cab->n_palavras);
+  fputc(cab->infinito, s->arquivo);
+  fflush(s->arquivo);
+  return true;
+}
+
+void sessao_grava_tecla(Sessao *s, long hora, char tecla)
+{
+  grava_varint(s->arquivo, hora - s->hora);
+  fputc(tecla, s->arquivo);
+  s->hora = hora;
+}
+
+void sessao_grava_fim(Sessao *s, long hora)
+{
+  grava_varint(s->arquivo, hora - s->hora);
+  fputc(0, s->arquivo);
+  s->hora = 0;
+  // uma sessão interrompida ainda tem as partidas completas
+  fflush(s->arquivo);
+}
+
+bool sessao_le(Sessao *s, const char *nome, CabecalhoSessao *cab)
+{
+  s->arquivo = fopen(nome, "rb");
+  if (s->arquivo == NULL) {
+    return false;
+  }
+  s->hora = 0;
+  char magico[sizeof(SESSAO_MAGICO)];
+  unsigned long semente, n_validas, n_palavras;
+  int versao, infinito;
+  if (fread(magico, 1, strlen(SESSAO_MAGICO), s->arquivo) != strlen(SESSAO_MAGICO)
+      || memcmp(magico, SESSAO_MAGICO, strlen(SESSAO_MAGICO)) != 0
+      || (versao = fgetc(s->arquivo)) != SESSAO_VERSAO
+      || !le_varint(s->arquivo, &semente)
+      || !le_varint(s->arquivo, &n_validas)
+      || !le_varint(s->arquivo, &n_palavras)
+      || (infinito = fgetc(s->arquivo)) == EOF) {
+    fclose(s->arquivo);
+    s->arquivo = NULL;
+    return false;
+  }
+  cab->semente = semente;
+  cab->n_validas = n_validas;
+  cab->n_palavras = n_palavras;
+  cab->infinito = infinito;
+  return true;
+}
+
+bool sessao_le_evento(Sessao *s, long *hora, char *tecla)
+{
+  unsigned long delta;
+  int c;
+  if (!le_varint(s->arquivo, &delta) || (c = fgetc(s->arquivo)) == EOF) {
+    return false;
+  }
+  *hora = s->hora + delta;
+  *tecla = c;
+  s->hora = c == 0 ? 0 : *hora;
+  return true;
+}
+
+void sessao_fecha(Sessao *s)
+{
+  if (s->arquivo != NULL) {
+    fclose(s->arquivo);
+    s->arquivo = NULL;
+  }
+}
@@ -0,0 +1,97 @@
+/**
+ * @file sessao.h
+ *
+ * @brief Definição do registro de sessões de jogo, para repeti-las depois.
+ *
+ * Uma sessão é gravada em um arquivo binário compacto: um cabeçalho com a
+ * semente do gerador de números aleatórios e as opções que mudam as regras,
+ * seguido dos eventos de cada partida. Cada evento é a diferença de tempo
+ * (em µs) para o evento anterior da partida e um byte: a tecla digitada, ou
+ * 0 no fim da partida. Números são gravados em varint (7 bits por byte, o
+ * bit mais alto indica que há mais bytes).
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#ifndef SESSAO_H
+#define SESSAO_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#define SESSAO_MAGICO "FWS" /**< Início de todo arquivo de sessão. */
+#define SESSAO_VERSAO 1 /**< Versão do formato, gravada depois do SESSAO_MAGICO. */
+
+/**
+ * @brief Cabeçalho de uma sessão: o que é preciso para repetir suas partidas.
+ */
+typedef struct {
+  unsigned long semente;  /**< Semente passada a srand no início da sessão. */
+  int n_validas;          /**< Número de palavras válidas no dicionário. */
+  int n_palavras;         /**< Número de palavras de cada partida. */
+  bool infinito;          /**< Se as partidas são do modo infinito. */
+} CabecalhoSessao;
+
+/**
+ * @brief Arquivo de sessão aberto para gravação ou leitura.
+ */
+typedef struct {
+  FILE *arquivo;   /**< Arquivo da sessão. */
+  long hora;       /**< Hora do último evento da partida atual, em µs. */
+} Sessao;
+
+/**
+ * @brief Cria um arquivo de sessão e grava seu cabeçalho.
+ *
+ * @param s Sessão.
+ * @param nome Nome do arquivo.
+ * @param cab Cabeçalho da sessão.
+ * @return Retorna true se o arquivo foi criado, false caso contrário.
+ */
+bool sessao_grava(Sessao *s, const char *nome, const CabecalhoSessao *cab);
+
+/**
+ * @brief Grava uma tecla digitada.
+ *
+ * @param s Sessão.
+ * @param hora Hora da tecla na partida, em µs.
+ * @param tecla Tecla digitada (diferente de 0).
+ */
+void sessao_grava_tecla(Sessao *s, long hora, char tecla);
+
+/**
+ * @brief Grava o fim de uma partida; os próximos eventos são da partida seguinte.
+ *
+ * @param s Sessão.
+ * @param hora Hora em que a partida terminou, em µs.
+ */
+void sessao_grava_fim(Sessao *s, long hora);
+
+/**
+ * @brief Abre um arquivo de sessão e lê seu cabeçalho.
+ *
+ * @param s Sessão.
+ * @param nome Nome do arquivo.
+ * @param cab Onde colocar o cabeçalho.
+ * @return Retorna true se o arquivo é uma sessão válida, false caso contrário.
+ */
+bool sessao_le(Sessao *s, const char *nome, CabecalhoSessao *cab);
+
+/**
+ * @brief Lê o próximo evento da sessão.
+ *
+ * @param s Sessão.
+ * @param hora Onde colocar a hora do evento na partida, em µs.
+ * @param tecla Onde colocar a tecla digitada, ou 0 no fim da partida.
+ * @return Retorna true se um evento foi lido, false no fim do arquivo.
+ */
+bool sessao_le_evento(Sessao *s, long *hora, char *tecla);
+
+/**
+ * @brief Fecha o arquivo de sessão.
+ *
+ * @param s Sessão.
+ */
+void sessao_fecha(Sessao *s);
+
+#endif /* SESSAO_H */
@@ -0,0 +1,238 @@
+/**
+ * @file simulacao.c
+ *
+ * @brief Implementação da simulação de partidas sem terminal.
+ *
+ * As partidas usam somente as regras do jogo, com relógio virtual: cada tique avança
+ * o relógio de 1/fps segundo, como se um quadro tivesse sido desenhado. As teclas vêm de
+ * um roteiro ou de um jogador simulado, sempre no mesmo ritmo.
+ *
+ * Também repete sessões gravadas: com a mesma semente e as mesmas teclas nas mesmas
+ * horas, as regras chegam exatamente ao mesmo resultado da sessão original.
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#include "simulacao.h"
+
+#include <time.h>
+
+/**
+ * @brief Lê o roteiro de teclas de um arquivo.
+ *
+ * @param nome Nome do arquivo.
+ * @param n Onde colocar o número de teclas.
+ * @return Teclas do roteiro (devem ser liberadas com free), ou NULL em caso de erro.
+ */
+static char *le_roteiro(const char *nome, int *n)
+{
+  FILE *arquivo = fopen(nome, "rb");
+  if (arquivo == NULL) {
+    return NULL;
+  }
+  int cap = 256;
+  char *teclas = malloc(cap);
+  *n = 0;
+  int c;
+  while (teclas != NULL && (c = fgetc(arquivo)) != EOF) {
+    if (c == '\n' || c == '\r') {
+      continue;
+    }
+    if (*n == cap) {
+      cap *= 2;
+      char *novo = realloc(teclas, cap);
+      if (novo == NULL) {
+        free(teclas);
+      }
+      teclas = novo;
+      if (teclas == NULL) {
+        break;
+      }
+    }
+    teclas[(*n)++] = c;
+  }
+  fclose(arquivo);
+  if (teclas != NULL && *n == 0) {
+    free(teclas);
+    teclas = NULL;
+  }
+  return teclas;
+}
+
+/**
+ * @brief Escolhe a tecla do jogador simulado.
+ *
+ * O jogador continua a palavra selecionada ou começa a palavra disponível há mais tempo
+ * com a primeira letra do alfabeto; de vez em quando, erra a tecla.
+ *
+ * @param p Partida.
+ * @return Tecla escolhida, ou '\0' se não há palavra para digitar.
+ */
+static char jogador_simulado(const Partida *p)
+{
+  if (rand() % 100 < CHANCE_ERRO) {
+    return 'a' + rand() % INDICE_N_LETRAS;
+  }
+  if (p->selecionada != -1) {
+    return p->reserva.letras[p->selecionada][p->reserva.digitadas[p->selecionada]];
+  }
+  for (int l = 0; l < INDICE_N_LETRAS; l++) {
+    if (p->indice.primeira[l] != -1) {
+      return 'a' + l;
+    }
+  }
+  return '\0';
+}
+
+bool simula(const Opcoes *opcoes)
+{
+  int n_roteiro = 0, prox_roteiro = 0;
+  char *roteiro = NULL;
+  if (opcoes->roteiro != NULL) {
+    roteiro = le_roteiro(opcoes->roteiro, &n_roteiro);
+    if (roteiro == NULL) {
+      fprintf(stderr, "Roteiro vazio ou impossível de ler: %s\n", opcoes->roteiro);
+      return false;
+    }
+  }
+
+  long tiques = 0, teclas = 0, pontos = 0, expiradas = 0;
+  double quadro = 1.0 / opcoes->fps;
+
+  // o relógio real só mede quanto a simulação demorou
+  Relogio real;
+  relogio_ini(&real);
+
+  for (int i = 0; i < opcoes->partidas; i++) {
+    Partida partida;
+    partida_ini(&partida, opcoes->n_palavras, opcoes->infinito);
+    Relogio relogio;
+    relogio_ini_virtual(&relogio);
+    double proxima_tecla = 1.0 / TECLAS_POR_SEGUNDO;
+    Ocorrencias oc;
+    do {
+      relogio_avanca(&relogio, quadro);
+      relogio_tique(&relogio);
+      double agora = relogio_agora(&relogio);
+      char tecla;
+      int n_teclas = 0;
+      if (agora >= proxima_tecla) {
+        if (roteiro != NULL) {
+          tecla = roteiro[prox_roteiro];
+          prox_roteiro = (prox_roteiro + 1) % n_roteiro;
+        } else {
+          tecla = jogador_simulado(&partida);
+        }
+        n_teclas = tecla != '\0';
+        proxima_tecla += 1.0 / TECLAS_POR_SEGUNDO;
+      }
+      partida_passo(&partida, agora, &tecla, NULL, n_teclas, &oc);
+      tiques++;
+      teclas += n_teclas;
+    } while (!oc.fim);
+    if (oc.expirou) {
+      expiradas++;
+    }
+    pontos += partida.pontos;
+    partida_fim(&partida);
+  }
+
+  relogio_tique(&real);
+  double segundos = relogio_agora(&real);
+  free(roteiro);
+
+  printf("partidas: %d (%ld terminadas por tempo de palavra)\n", opcoes->partidas, expiradas);
+  printf("tiques: %ld\n", tiques);
+  printf("teclas: %ld\n", teclas);
+  printf("pontos por partida: %.1f\n", (double)pontos / opcoes->partidas);
+  printf("tempo: %.3f s\n", segundos);
+  if (segundos > 0) {
+    printf("tiques por segundo: %.0f\n", tiques / segundos);
+  }
+  return true;
+}
+
+/**
+ * @brief Espera, sem ocupar o processador, até o relógio chegar na hora dada.
+ *
+ * @param r Relógio.
+ * @param hora Hora a esperar, em segundos.
+ */
+static void espera_ate(Relogio *r, double hora)
+{
+  relogio_tique(r);
+  double falta = hora - relogio_agora(r);
+  if (falta > 0) {
+    struct timespec t = { .tv_sec = falta, .tv_nsec = (falta - (long)falta) * 1e9 };
+    nanosleep(&t, NULL);
+  }
+}
+
+bool repete(const Opcoes *opcoes)
+{
+  Sessao sessao;
+  CabecalhoSessao cab;
+  if (!sessao_le(&sessao, opcoes->repete, &cab)) {
+    fprintf(stderr, "Não é um arquivo de sessão: %s\n", opcoes->repete);
+    return false;
+  }
+  // as palavras sorteadas dependem do dicionário
+  if (cab.n_validas != dicionario_tamanho()) {
+    fprintf(stderr, "A sessão foi gravada com outro arquivo de palavras (%d palavras válidas, não %d)\n",
+            cab.n_validas, dicionario_tamanho());
+    sessao_fecha(&sessao);
+    return false;
+  }
+  srand(cab.semente);
+
+  int partidas = 0;
+  long teclas = 0, passos = 0;
+  Relogio real;
+  relogio_ini(&real);
+  bool fim_do_arquivo = false;
+  while (!fim_do_arquivo) {
+    Partida partida;
+    partida_ini(&partida, cab.n_palavras, cab.infinito);
+    Relogio relogio;
+    relogio_ini(&relogio);
+    long n_teclas = 0;
+    long hora;
+    char tecla;
+    Ocorrencias oc = { 0 };
+    for (;;) {
+      if (!sessao_le_evento(&sessao, &hora, &tecla)) {
+        fim_do_arquivo = true;
+        break;
+      }
+      if (!opcoes->rapido) {
+        espera_ate(&relogio, hora * 1e-6);
+      }
+      partida_passo(&partida, hora * 1e-6, &tecla, NULL, tecla != '\0', &oc);
+      passos++;
+      if (tecla == '\0') {
+        break;
+      }
+      n_teclas++;
+    }
+    // uma partida interrompida no meio da gravação não é mostrada
+    if (!fim_do_arquivo) {
+      partidas++;
+      teclas += n_teclas;
+      printf("partida %d: %d pontos, %d palavras restantes, %ld teclas, %.3f s%s\n",
+             partidas, partida.pontos, partida.reserva.n, n_teclas, hora * 1e-6,
+             oc.expirou ? ", terminada por tempo de palavra" : "");
+    }
+    partida_fim(&partida);
+  }
+  sessao_fecha(&sessao);
+
+  relogio_tique(&real);
+  double segundos = relogio_agora(&real);
+  printf("partidas: %d\n", partidas);
+  printf("teclas: %ld\n", teclas);
+  printf("tempo: %.3f s\n", segundos);
+  if (opcoes->rapido && segundos > 0) {
+    printf("passos por segundo: %.0f\n", passos / segundos);
+  }
+  return true;
+}
@@ -0,0 +1,39 @@
+/**
+ * @file simulacao.h
+ *
+ * @brief Definição da simulação de partidas sem terminal.
+ *
+ * @author Luiz Felipe Cavalheiro
+ */
+
+#ifndef SIMULACAO_H
+#define SIMULACAO_H
+
+#include "funcoes.h"
+
+// definições de constantes
+#define TECLAS_POR_SEGUNDO 8 /**< Velocidade de digitação do jogador simulado. */
+#define CHANCE_ERRO 5 /**< Porcentagem de teclas erradas do jogador simulado. */
+
+// definições de funções
+
+/**
+ * @brief Simula partidas sem tela nem teclado e mostra quantos tiques por segundo foram executados.
+ *
+ * @param opcoes Opções escolhidas na linha de comando.
+ * @return Retorna true se a simulação foi executada, false caso contrário.
+ */
+bool simula(const Opcoes *opcoes);
+
+/**
+ * @brief Repete as partidas de uma sessão gravada e mostra seus resultados.
+ *
+ * As teclas são entregues às regras nas horas em que foram digitadas: no tempo real ou,
+ * se opcoes->rapido, o mais rápido possível.
+ *
+ * @param opcoes Opções escolhidas na linha de comando.
+ * @return Retorna true se a sessão foi repetida, false caso contrário.
+ */
+bool repete(const Opcoes *opcoes);
+
+#endif /* SIMULACAO_H */
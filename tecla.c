@@ -8,13 +8,38 @@
 
 #include "tecla.h"
 
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
 #include <termios.h>
 #include <unistd.h>
+#include <poll.h>
+#include <time.h>
 
+// descritor de onde são lidas as teclas
+#define FD_TECLADO 0
 
 // variável global para guardar a configuração original do
 //   teclado
 static struct termios estado_original_do_teclado;
+// configuração usada durante o jogo
+static struct termios estado_do_jogo;
+// hora em que foram lidos os bytes da última tecla
+static double hora_ultima_tecla;
+
+// bytes lidos do teclado e ainda não entregues; uma leitura pega tudo o
+//   que estiver disponível, e as teclas são entregues daqui
+static char bytes[TECLA_N_BYTES];
+static int n_bytes;   // quantos bytes há no buffer
+static int pos_bytes; // posição do próximo byte a entregar
+// hora da leitura que trouxe os bytes do buffer
+static double hora_leitura;
+// se a última leitura não trouxe nada (e uma seqüência incompleta no fim do
+//   buffer não vai mais ser completada)
+static bool leitura_vazia;
+// se o teclado foi fechado: uma leitura feita depois de poll avisar que havia
+//   o que ler não trouxe nada (fim do arquivo, terminal desligado) ou falhou
+static bool fechado;
 
 // muda o processamento de caracteres de entrada pelo terminal
 //   para que a leitura seja feita em caracteres individuais, sem esperar
@@ -23,29 +48,199 @@ static struct termios estado_original_do_teclado;
 void tecla_ini(void)
 {
   // lê e guarda o estado atual do terminal
-  tcgetattr(1, &estado_original_do_teclado);
+  tcgetattr(FD_TECLADO, &estado_original_do_teclado);
   // altera o estado do terminal para não ecoar o que é digitado
   //   nem esperar <enter>
   struct termios t = estado_original_do_teclado;
   t.c_lflag &= (~ECHO & ~ICANON);
   t.c_cc[VMIN] = 0; // pode retornar de uma leitura sem nenhum caractere
-  t.c_cc[VTIME] = 1; // espera até tantos décimos de segundo antes de retornar
+  t.c_cc[VTIME] = 0; // não espera: a leitura retorna o que já chegou
   // envia a nova configuração para o sistema
-  tcsetattr(1, TCSANOW, &t);
+  tcsetattr(FD_TECLADO, TCSANOW, &t);
+  estado_do_jogo = t;
+  n_bytes = pos_bytes = 0;
 }
 
 // configura o teclado para o modo que estava quando tecla_ini foi chamada
 // esta função deve ser chamada no final da execução do programa
 void tecla_fim(void)
 {
-  tcsetattr(1, TCSANOW, &estado_original_do_teclado);
+  tcsetattr(FD_TECLADO, TCSANOW, &estado_original_do_teclado);
+}
+
+// lê de uma vez tudo o que estiver disponível no teclado, depois dos bytes
+//   ainda não entregues
+// retorna false se a leitura não trouxe nada porque o teclado foi fechado
+//   (só faz sentido quando poll avisou que havia o que ler: com VMIN 0, uma
+//   leitura sem nada disponível também retorna 0)
+static bool le_bytes(void)
+{
+  if (pos_bytes > 0) {
+    memmove(bytes, bytes + pos_bytes, n_bytes - pos_bytes);
+    n_bytes -= pos_bytes;
+    pos_bytes = 0;
+  }
+  int pedidos = TECLA_N_BYTES - n_bytes;
+  ssize_t lidos = read(FD_TECLADO, bytes + n_bytes, pedidos);
+  leitura_vazia = lidos <= 0;
+  if (lidos > 0) {
+    n_bytes += lidos;
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    hora_leitura = agora.tv_sec + agora.tv_nsec*1e-9;
+  }
+  if (lidos < 0) {
+    return errno == EINTR || errno == EAGAIN;
+  }
+  return lidos > 0 || pedidos == 0;
+}
+
+// número de bytes da tecla que começa em bytes[pos_bytes], ou 0 se a
+//   seqüência ainda não chegou inteira
+// uma seqüência de escape (ESC [ ... final, ESC O x, ESC x) ou um caractere
+//   UTF-8 de vários bytes é uma tecla só
+static int tam_tecla(void)
+{
+  unsigned char *b = (unsigned char *)bytes + pos_bytes;
+  int n = n_bytes - pos_bytes;
+  if (b[0] == '\033') {
+    if (n == 1) {
+      return 1; // ESC sozinho
+    }
+    if (b[1] == '[') {
+      // parâmetros e intermediários, até o byte final (0x40 a 0x7e)
+      for (int i = 2; i < n; i++) {
+        if (b[i] >= 0x40 && b[i] <= 0x7e) {
+          return i + 1;
+        }
+      }
+      return 0;
+    }
+    if (b[1] == 'O') {
+      return n >= 3 ? 3 : 0;
+    }
+    return 2; // alt + tecla
+  }
+  int tam;
+  if (b[0] < 0x80) {
+    return 1;
+  } else if (b[0] >= 0xc2 && b[0] <= 0xdf) {
+    tam = 2;
+  } else if (b[0] >= 0xe0 && b[0] <= 0xef) {
+    tam = 3;
+  } else if (b[0] >= 0xf0 && b[0] <= 0xf4) {
+    tam = 4;
+  } else {
+    return 1; // byte inválido, entregue sozinho
+  }
+  for (int i = 1; i < tam; i++) {
+    if (i == n) {
+      return 0;
+    }
+    if ((b[i] & 0xc0) != 0x80) {
+      return i; // seqüência interrompida: o que veio até aqui é uma tecla
+    }
+  }
+  return tam;
+}
+
+// entrega a próxima tecla do buffer, ou 0 se não há uma completa
+static char proxima_tecla(void)
+{
+  if (pos_bytes == n_bytes) {
+    return 0;
+  }
+  int tam = tam_tecla();
+  if (tam == 0) {
+    if (!leitura_vazia && n_bytes < TECLA_N_BYTES) {
+      return 0; // o resto da seqüência deve estar chegando
+    }
+    tam = n_bytes - pos_bytes; // não vai chegar: entrega o que tem
+  }
+  unsigned char b = bytes[pos_bytes];
+  char tecla = tam == 1 && b < 0x80 ? b : TECLA_ESPECIAL;
+  pos_bytes += tam;
+  hora_ultima_tecla = hora_leitura;
+  return tecla;
 }
 
 char tecla_le_char(void)
 {
-  char a;
-  if (read(1, &a, 1) != 1) {
-    return 0; // nada foi digitado
+  char tecla = proxima_tecla();
+  if (tecla == 0) {
+    le_bytes();
+    tecla = proxima_tecla();
+  }
+  return tecla;
+}
+
+int tecla_le_teclas(char *teclas, int max)
+{
+  if (!le_bytes()) {
+    fechado = true;
+  }
+  int n = 0;
+  char tecla;
+  while (n < max && (tecla = proxima_tecla()) != 0) {
+    teclas[n++] = tecla;
   }
-  return a;
+  return n == 0 && fechado ? -1 : n;
+}
+
+char tecla_espera_char(int tempo_ms)
+{
+  char tecla = proxima_tecla();
+  if (tecla != 0) {
+    return tecla;
+  }
+  if (fechado) {
+    return 0; // não vai chegar mais nada
+  }
+  struct pollfd p = { .fd = FD_TECLADO, .events = POLLIN };
+  // poll dorme até chegar algo ou acabar o tempo
+  if (poll(&p, 1, tempo_ms) != 1) {
+    return 0;
+  }
+  if (!le_bytes()) {
+    fechado = true;
+  }
+  return proxima_tecla();
+}
+
+int tecla_le_linha(char *linha, int tam)
+{
+  // o que foi digitado antes e ainda não foi lido não faz parte da linha
+  n_bytes = pos_bytes = 0;
+  // durante a leitura, o terminal volta ao modo de linha, com eco;
+  //   read fica bloqueado até ser digitado <enter>
+  struct termios t = estado_do_jogo;
+  t.c_lflag |= ECHO | ICANON;
+  tcsetattr(FD_TECLADO, TCSANOW, &t);
+
+  int n = 0;
+  char c;
+  while (read(FD_TECLADO, &c, 1) == 1 && c != '\n') {
+    if (n < tam - 1) {
+      linha[n++] = c;
+    }
+  }
+  linha[n] = '\0';
+
+  tcsetattr(FD_TECLADO, TCSANOW, &estado_do_jogo);
+  return n;
+}
+
+bool tecla_fechada(void)
+{
+  return fechado;
+}
+
+double tecla_hora(void)
+{
+  return hora_ultima_tecla;
+}
+
+int tecla_descritor(void)
+{
+  return FD_TECLADO;
 }
@@ -9,6 +9,13 @@
 #ifndef TECLA_H
 #define TECLA_H
 
+#include <stdbool.h>
+
+// tamanho do buffer de leitura do teclado
+#define TECLA_N_BYTES 256
+// tecla entregue no lugar de uma seqüência de escape (setas, teclas de
+//   função, alt + tecla) ou de um caractere UTF-8 de vários bytes
+#define TECLA_ESPECIAL '\033'
 
 // muda o processamento de caracteres de entrada pelo terminal
 //   para que a leitura seja feita em caracteres individuais, sem esperar
@@ -22,6 +29,39 @@ void tecla_fim(void);
 
 // retorna o próximo caractere lido do teclado, ou 0 se não tiver nenhum
 //   caractere a ser lido
+// as teclas de vários bytes são entregues como um só TECLA_ESPECIAL
 char tecla_le_char(void);
 
+// lê de uma vez tudo o que foi digitado e ainda não foi lido, colocando
+//   até max teclas em teclas (as outras ficam para a próxima leitura)
+// deve ser chamada quando poll avisar que há o que ler no teclado
+// retorna o número de teclas colocadas, ou -1 se o teclado foi fechado
+//   (fim do arquivo, terminal desligado ou erro de leitura) e não sobrou
+//   nenhuma tecla
+int tecla_le_teclas(char *teclas, int max);
+
+// espera por um caractere do teclado, sem ocupar o processador, por até
+//   tempo_ms milissegundos (para sempre se tempo_ms for negativo)
+// retorna o caractere lido, ou 0 se o tempo acabou ou o teclado foi fechado
+char tecla_espera_char(int tempo_ms);
+
+// lê uma linha inteira do teclado, esperando sem ocupar o processador
+//   enquanto nada é digitado; durante a leitura o próprio terminal mostra
+//   o que é digitado e trata o apagamento de caracteres
+// coloca em linha até tam-1 caracteres (sem o '\n') e um '\0'; o que for
+//   digitado a mais na linha é descartado
+// retorna o número de caracteres colocados em linha
+int tecla_le_linha(char *linha, int tam);
+
+// retorna a hora (no mesmo relógio de tela_relogio) em que foi lido o
+//   último caractere retornado por tecla_le_char ou tecla_le_teclas
+double tecla_hora(void);
+
+// retorna true se o teclado foi fechado: nenhuma tecla vai mais chegar
+bool tecla_fechada(void);
+
+// retorna o descritor de onde as teclas são lidas, para quem quiser
+//   esperar por elas (com poll, por exemplo)
+int tecla_descritor(void);
+
 #endif // TECLA_H
@@ -13,136 +13,865 @@
 // implementado usando
 //   - sequências de escape ANSI para controlar a saída (cursor, cores)
 //   - ioctl para descobrir o tamanho do terminal
-//   - signal para ser sinalizado quando o terminal mudar de tamanho
+//   - sigaction para ser sinalizado quando o terminal mudar de tamanho; o
+//     tratador só escreve um byte num pipe, e o tamanho é lido depois, fora
+//     do tratador, uma vez por quadro no máximo
 //   - clock_gettime para obter o valor do relógio com boa resolução
+//   - write para enviar cada quadro ao terminal de uma só vez
+//
+// a tela é mantida em memória em duas grades de células (caractere e
+// cores): a grade visível, com o que está no terminal, e a grade de
+// desenho, onde são feitas as impressões. tela_atualiza compara as duas
+// e envia ao terminal somente as células que mudaram. só são comparadas
+// as linhas em que houve impressão ou limpeza desde a última comparação,
+// então um quadro sem mudanças custa pouco mesmo numa tela grande.
 
 
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
 
 #include <signal.h>
 #include <time.h>
 #include <sys/ioctl.h>
 #include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
 
 
-static void tela_altera_modo_saida(void)
+// valor de cor que representa a cor normal do terminal
+#define COR_NORMAL -1
+
+// maior número de bytes enviados para uma célula (posicionamento,
+// cor da letra, cor do fundo e caractere)
+#define BYTES_POR_CELULA 64
+
+// uma posição da tela: um caractere (em UTF-8) e suas cores
+typedef struct {
+  char glifo[4];   // bytes do caractere; os não usados são 0
+  int cor_letra;   // 0xRRGGBB ou COR_NORMAL
+  int cor_fundo;   // 0xRRGGBB ou COR_NORMAL
+} celula_t;
+
+static const celula_t celula_vazia = { { ' ' }, COR_NORMAL, COR_NORMAL };
+
+// cores que o terminal sabe mostrar
+#define CORES_24BITS 0  // qualquer cor, com \e[38;2;R;G;Bm
+#define CORES_256 1     // paleta de 256 cores, com \e[38;5;Nm
+#define CORES_16 2      // as 16 cores básicas, com \e[3Nm e \e[9Nm
+
+// destino dos quadros de uma tela
+#define SAIDA_TERMINAL 0  // enviados ao terminal
+#define SAIDA_DESCARTA 1  // descartados, mas contados (para medir o desenho)
+#define SAIDA_ACUMULA 2   // guardados até serem entregues por quem usa a tela
+
+// estado de uma tela
+struct tela {
+  // tamanho desejado
+  int nlin, ncol;
+
+  // grades de células e seu tamanho
+  celula_t *visivel;
+  celula_t *desenho;
+  int grade_nlin, grade_ncol;
+  // por linha da grade de desenho: se ela pode ser diferente da visível
+  //   (precisa ser comparada), e se algo foi impresso nela desde a última
+  //   limpeza (senão ela está vazia e a limpeza não muda nada)
+  bool *linha_suja;
+  bool *linha_escrita;
+  // se true, o conteúdo do terminal é desconhecido e deve ser todo redesenhado
+  bool redesenha_tudo;
+
+  // estado usado pelas impressões na grade de desenho
+  int cursor_lin, cursor_col;
+  int cor_letra_atual;
+  int cor_fundo_atual;
+
+  // estado do terminal (cursor e cores), conforme o que já foi enviado;
+  // posição -1 significa desconhecida
+  int saida_lin, saida_col;
+  int saida_cor_letra;
+  int saida_cor_fundo;
+
+  // os bytes a enviar ao terminal são acumulados em uma região de memória
+  // e enviados todos juntos em tela_atualiza. Isso melhora a qualidade de
+  // apresentação na tela e diminui o número de chamadas ao sistema
+  char *saida;
+  int saida_tam, saida_cap;
+  // bytes do início da saída que são de quadros anteriores, ainda não
+  // entregues (com SAIDA_ACUMULA, ou com SAIDA_TERMINAL sem bloquear)
+  int saida_pendente;
+  // se os envios ao terminal não esperam (ver tela_nao_bloqueia)
+  bool nao_bloqueia;
+  // se um quadro deixou de ser enviado porque o terminal estava atrasado;
+  //   a grade de desenho ainda tem esse quadro
+  bool quadro_retido;
+  // para onde vão os quadros (SAIDA_*)
+  int destino;
+  // cores que o terminal sabe mostrar (CORES_*)
+  int cores;
+
+  tela_estatisticas_t estatisticas;
+
+  // dados de quem desenha na tela, e a função que os libera
+  void *dados;
+  void (*libera_dados)(void *dados);
+};
+
+#define TELA_INICIAL { \
+  .redesenha_tudo = true, \
+  .cor_letra_atual = COR_NORMAL, .cor_fundo_atual = COR_NORMAL, \
+  .saida_lin = -1, .saida_col = -1, \
+  .saida_cor_letra = COR_NORMAL, .saida_cor_fundo = COR_NORMAL, \
+}
+
+// a tela do terminal, e a tela onde as funções atuam
+static tela_t tela_terminal = TELA_INICIAL;
+static tela_t *t = &tela_terminal;
+
+static void tela_saida_reserva(int n)
+{
+  if (t->saida_tam + n <= t->saida_cap) {
+    return;
+  }
+  int cap = t->saida_cap * 2;
+  if (cap < t->saida_tam + n) {
+    cap = t->saida_tam + n;
+  }
+  char *nova = realloc(t->saida, cap);
+  if (nova == NULL) {
+    perror("Sem memória para a tela");
+    exit(1);
+  }
+  t->saida = nova;
+  t->saida_cap = cap;
+}
+
+static void tela_saida_bytes(const char *bytes, int n)
+{
+  tela_saida_reserva(n);
+  memcpy(t->saida + t->saida_tam, bytes, n);
+  t->saida_tam += n;
+}
+
+static void tela_saida_texto(const char *texto)
 {
-  // faz com que os caracteres impressos sejam enviados para uma
-  // região de memória antes de serem enviados à tela. Isso melhora
-  // a qualidade de apresentação na tela
-  setbuf(stdout, malloc(BUFSIZ));
+  tela_saida_bytes(texto, strlen(texto));
+}
+
+static void tela_saida_formatada(const char *formato, ...)
+{
+  char texto[64];
+  va_list args;
+  va_start(args, formato);
+  int n = vsnprintf(texto, sizeof(texto), formato, args);
+  va_end(args);
+  tela_saida_bytes(texto, n);
+}
+
+// envia ao terminal tudo o que foi acumulado, normalmente com uma
+// única chamada a write
+static void tela_saida_envia(void)
+{
+  t->estatisticas.escritas = 0;
+  t->estatisticas.bytes = 0;
+  int enviados = 0;
+  if (t->destino == SAIDA_ACUMULA) {
+    // o quadro fica depois dos anteriores, esperando ser entregue
+    t->estatisticas.bytes = t->saida_tam - t->saida_pendente;
+    t->saida_pendente = t->saida_tam;
+    t->estatisticas.quadros++;
+    t->estatisticas.total_bytes += t->estatisticas.bytes;
+    return;
+  }
+  if (t->destino == SAIDA_DESCARTA) {
+    // conta a escrita que seria feita ao terminal
+    t->estatisticas.escritas = t->saida_tam > 0;
+    enviados = t->saida_tam;
+  }
+  bool atrasado = false;
+  while (enviados < t->saida_tam) {
+    ssize_t n = write(1, t->saida + enviados, t->saida_tam - enviados);
+    t->estatisticas.escritas++;
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      atrasado = errno == EAGAIN || errno == EWOULDBLOCK;
+      break;
+    }
+    enviados += n;
+  }
+  t->estatisticas.bytes = enviados;
+  t->estatisticas.quadros++;
+  t->estatisticas.total_escritas += t->estatisticas.escritas;
+  t->estatisticas.total_bytes += t->estatisticas.bytes;
+  if (atrasado) {
+    // o que o terminal não aceitou fica para o próximo envio
+    memmove(t->saida, t->saida + enviados, t->saida_tam - enviados);
+    t->saida_tam -= enviados;
+  } else {
+    t->saida_tam = 0;
+  }
+  t->saida_pendente = t->saida_tam;
 }
 
 void tela_mostra_cursor(bool mostra)
 {
   if (mostra) {
-    printf("\e[?25h");
+    tela_saida_texto("\e[?25h");
   } else {
-    printf("\e[?25l");
+    tela_saida_texto("\e[?25l");
   }
 }
 
 static void tela_seleciona_tela_alternativa(bool alt)
 {
   if (alt) {
-    printf("\e[?1049h");
+    tela_saida_texto("\e[?1049h");
   } else {
-    printf("\e[?1049l");
+    tela_saida_texto("\e[?1049l");
+  }
+}
+
+static bool tela_le_nlincol(void);
+static int tela_detecta_cores(void);
+static void tela_restaura_flags(void);
+
+// pipe onde o tratador de SIGWINCH avisa que o terminal mudou de tamanho
+static int pipe_tamanho[2] = { -1, -1 };
+
+// tratador de SIGWINCH: só usa write, que pode ser chamada num tratador
+//   de sinal; se o pipe estiver cheio, já há aviso pendente
+static void tela_sinal_tamanho(int sinal)
+{
+  (void)sinal;
+  int erro = errno;
+  char c = 0;
+  write(pipe_tamanho[1], &c, 1); // falha se o pipe está cheio
+  errno = erro;
+}
+
+// prepara o aviso de mudança de tamanho do terminal
+static void tela_ini_sinal_tamanho(void)
+{
+  if (pipe(pipe_tamanho) != 0) {
+    pipe_tamanho[0] = pipe_tamanho[1] = -1;
+    return;
+  }
+  for (int i = 0; i < 2; i++) {
+    fcntl(pipe_tamanho[i], F_SETFL, fcntl(pipe_tamanho[i], F_GETFL) | O_NONBLOCK);
+    fcntl(pipe_tamanho[i], F_SETFD, FD_CLOEXEC);
+  }
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = tela_sinal_tamanho;
+  sigemptyset(&sa.sa_mask);
+  sa.sa_flags = SA_RESTART;
+  sigaction(SIGWINCH, &sa, NULL);
+}
+
+static void tela_fim_sinal_tamanho(void)
+{
+  if (pipe_tamanho[0] == -1) {
+    return;
   }
+  signal(SIGWINCH, SIG_DFL);
+  close(pipe_tamanho[0]);
+  close(pipe_tamanho[1]);
+  pipe_tamanho[0] = pipe_tamanho[1] = -1;
 }
 
-static void tela_le_nlincol(int);
+
+// (re)aloca as grades se o tamanho do terminal mudou
+static void tela_ajusta_grades(void)
+{
+  int l = t->nlin, c = t->ncol;
+  if (t->visivel != NULL && l == t->grade_nlin && c == t->grade_ncol) {
+    return;
+  }
+  free(t->visivel);
+  free(t->desenho);
+  free(t->linha_suja);
+  free(t->linha_escrita);
+  t->visivel = malloc(l * c * sizeof(celula_t));
+  t->desenho = malloc(l * c * sizeof(celula_t));
+  t->linha_suja = malloc(l * sizeof(bool));
+  t->linha_escrita = malloc(l * sizeof(bool));
+  if (t->visivel == NULL || t->desenho == NULL
+      || t->linha_suja == NULL || t->linha_escrita == NULL) {
+    perror("Sem memória para a tela");
+    exit(1);
+  }
+  t->grade_nlin = l;
+  t->grade_ncol = c;
+  // a região de saída comporta um quadro inteiro; as telas que acumulam
+  // quadros costumam ser muitas e pequenas, e crescem quando precisam
+  if (t->destino != SAIDA_ACUMULA) {
+    tela_saida_reserva(l * c * BYTES_POR_CELULA);
+  }
+  for (int i = 0; i < l * c; i++) {
+    t->desenho[i] = celula_vazia;
+  }
+  for (int lin = 0; lin < l; lin++) {
+    t->linha_escrita[lin] = false;
+  }
+  t->redesenha_tudo = true;
+}
 
 void tela_ini(void)
 {
-  tela_altera_modo_saida();
+  t->cores = tela_detecta_cores();
   tela_seleciona_tela_alternativa(true);
-  // chama tela_le_nlincol se tela mudar de tamanho
-  signal(SIGWINCH, tela_le_nlincol);
-  tela_le_nlincol(0);
+  // avisa quando a tela mudar de tamanho
+  tela_ini_sinal_tamanho();
+  if (!tela_le_nlincol()) {
+    fprintf(stderr, "Não consegui identificar tamanho do terminal, usando %dx%d\n",
+        tela_terminal.nlin, tela_terminal.ncol);
+  }
+  tela_ajusta_grades();
   tela_limpa();
   //tela_mostra_cursor(false);
 }
 
-void tela_fim(void)
+void tela_ini_memoria(int lin, int col)
 {
+  t->destino = SAIDA_DESCARTA;
+  t->nlin = lin;
+  t->ncol = col;
+  tela_ajusta_grades();
   tela_limpa();
+}
+
+void tela_fim(void)
+{
+  tela_nao_bloqueia(false);
+  tela_restaura_flags();
+  tela_saida_texto("\e[m\e[2J");
   tela_seleciona_tela_alternativa(false);
   tela_mostra_cursor(true);
+  tela_saida_envia();
+  if (t == &tela_terminal) {
+    tela_fim_sinal_tamanho();
+  }
+  tela_guarda_dados(NULL, NULL);
+  free(t->visivel);
+  free(t->desenho);
+  free(t->linha_suja);
+  free(t->linha_escrita);
+  free(t->saida);
+  t->visivel = t->desenho = NULL;
+  t->linha_suja = t->linha_escrita = NULL;
+  t->saida = NULL;
+  t->saida_tam = t->saida_cap = 0;
+  t->destino = SAIDA_TERMINAL;
+}
+
+tela_t *tela_cria(int nlin, int ncol)
+{
+  tela_t *nova = malloc(sizeof(tela_t));
+  if (nova == NULL) {
+    return NULL;
+  }
+  *nova = (tela_t)TELA_INICIAL;
+  nova->nlin = nlin;
+  nova->ncol = ncol;
+  nova->destino = SAIDA_ACUMULA;
+  return nova;
+}
+
+void tela_destroi(tela_t *tela)
+{
+  if (tela == NULL) {
+    return;
+  }
+  if (t == tela) {
+    t = &tela_terminal;
+  }
+  if (tela->libera_dados != NULL) {
+    tela->libera_dados(tela->dados);
+  }
+  free(tela->visivel);
+  free(tela->desenho);
+  free(tela->linha_suja);
+  free(tela->linha_escrita);
+  free(tela->saida);
+  free(tela);
+}
+
+tela_t *tela_seleciona(tela_t *tela)
+{
+  tela_t *anterior = t == &tela_terminal ? NULL : t;
+  t = tela == NULL ? &tela_terminal : tela;
+  return anterior;
+}
+
+const char *tela_pendente(int *n)
+{
+  *n = t->saida_pendente;
+  return t->saida;
+}
+
+void tela_entregue(int n)
+{
+  memmove(t->saida, t->saida + n, t->saida_tam - n);
+  t->saida_tam -= n;
+  t->saida_pendente -= n;
+}
+
+static bool celulas_iguais(const celula_t *a, const celula_t *b)
+{
+  return memcmp(a->glifo, b->glifo, sizeof(a->glifo)) == 0
+      && a->cor_letra == b->cor_letra
+      && a->cor_fundo == b->cor_fundo;
+}
+
+// descobre pelas variáveis de ambiente quantas cores o terminal mostra
+static int tela_detecta_cores(void)
+{
+  const char *colorterm = getenv("COLORTERM");
+  if (colorterm != NULL
+      && (strcmp(colorterm, "truecolor") == 0 || strcmp(colorterm, "24bit") == 0)) {
+    return CORES_24BITS;
+  }
+  const char *term = getenv("TERM");
+  if (term != NULL && (strstr(term, "truecolor") != NULL || strstr(term, "direct") != NULL)) {
+    return CORES_24BITS;
+  }
+  if (term != NULL && strstr(term, "256color") != NULL) {
+    return CORES_256;
+  }
+  return CORES_16;
+}
+
+static int quadrado(int x)
+{
+  return x * x;
+}
+
+static int distancia(int cor, int r, int g, int b)
+{
+  return quadrado((cor >> 16) - r) + quadrado(((cor >> 8) & 0xff) - g) + quadrado((cor & 0xff) - b);
+}
+
+// índice da cor mais próxima na paleta de 256 cores: o cubo 6x6x6
+//   (16 a 231) ou a escala de cinzas (232 a 255)
+static int tela_cor_256(int cor)
+{
+  static const int niveis[6] = { 0, 95, 135, 175, 215, 255 };
+  int comp[3] = { cor >> 16, (cor >> 8) & 0xff, cor & 0xff };
+  int ind[3];
+  for (int i = 0; i < 3; i++) {
+    ind[i] = comp[i] < 48 ? 0 : comp[i] < 115 ? 1 : (comp[i] - 35) / 40;
+  }
+  int cubo = 16 + 36 * ind[0] + 6 * ind[1] + ind[2];
+  int media = (comp[0] + comp[1] + comp[2]) / 3;
+  int cinza = media > 238 ? 23 : media < 8 ? 0 : (media - 8) / 10;
+  int v = 8 + 10 * cinza;
+  if (distancia(cor, v, v, v)
+      < distancia(cor, niveis[ind[0]], niveis[ind[1]], niveis[ind[2]])) {
+    return 232 + cinza;
+  }
+  return cubo;
+}
+
+// índice (0 a 15) da cor básica mais próxima, com as cores do xterm
+static int tela_cor_16(int cor)
+{
+  static const int basicas[16] = {
+    0x000000, 0xcd0000, 0x00cd00, 0xcdcd00, 0x0000ee, 0xcd00cd, 0x00cdcd, 0xe5e5e5,
+    0x7f7f7f, 0xff0000, 0x00ff00, 0xffff00, 0x5c5cff, 0xff00ff, 0x00ffff, 0xffffff,
+  };
+  int melhor = 0;
+  for (int i = 1; i < 16; i++) {
+    int b = basicas[i];
+    if (distancia(cor, b >> 16, (b >> 8) & 0xff, b & 0xff)
+        < distancia(cor, basicas[melhor] >> 16, (basicas[melhor] >> 8) & 0xff,
+                    basicas[melhor] & 0xff)) {
+      melhor = i;
+    }
+  }
+  return melhor;
+}
+
+// parâmetros SGR de uma cor já montados, para não refazer as contas nem
+//   formatar o texto a cada mudança de cor
+#define N_CORES_MONTADAS 32
+typedef struct {
+  int cor;          // 0xRRGGBB
+  bool fundo;       // se é cor de fundo
+  int cores;        // CORES_* para que foi montada
+  char sgr[20];     // parâmetros, como "38;2;250;250;30" ou "93"
+} cor_montada_t;
+
+static cor_montada_t cores_montadas[N_CORES_MONTADAS];
+static int n_cores_montadas;
+
+// retorna os parâmetros SGR da cor, montando-os se ainda não estão prontos
+static const char *tela_sgr_cor(int cor, bool fundo)
+{
+  int n = n_cores_montadas < N_CORES_MONTADAS ? n_cores_montadas : N_CORES_MONTADAS;
+  for (int i = 0; i < n; i++) {
+    cor_montada_t *m = &cores_montadas[i];
+    if (m->cor == cor && m->fundo == fundo && m->cores == t->cores) {
+      return m->sgr;
+    }
+  }
+  // as mais antigas dão lugar às novas
+  cor_montada_t *m = &cores_montadas[n_cores_montadas++ % N_CORES_MONTADAS];
+  m->cor = cor;
+  m->fundo = fundo;
+  m->cores = t->cores;
+  if (t->cores == CORES_24BITS) {
+    snprintf(m->sgr, sizeof(m->sgr), "%d;2;%d;%d;%d",
+             fundo ? 48 : 38, cor >> 16, (cor >> 8) & 0xff, cor & 0xff);
+  } else if (t->cores == CORES_256) {
+    snprintf(m->sgr, sizeof(m->sgr), "%d;5;%d", fundo ? 48 : 38, tela_cor_256(cor));
+  } else {
+    int i = tela_cor_16(cor);
+    snprintf(m->sgr, sizeof(m->sgr), "%d", (i < 8 ? 30 : 90) + (fundo ? 10 : 0) + i % 8);
+  }
+  return m->sgr;
+}
+
+// envia as cores que mudaram, numa única seqüência SGR
+static void tela_envia_cores(int letra, int fundo)
+{
+  if (letra == t->saida_cor_letra && fundo == t->saida_cor_fundo) {
+    return;
+  }
+  tela_saida_texto("\e[");
+  bool primeiro = true;
+  // não tem como voltar só uma das cores para o normal
+  if ((letra == COR_NORMAL && t->saida_cor_letra != COR_NORMAL)
+      || (fundo == COR_NORMAL && t->saida_cor_fundo != COR_NORMAL)) {
+    tela_saida_texto("0");
+    primeiro = false;
+    t->saida_cor_letra = t->saida_cor_fundo = COR_NORMAL;
+  }
+  if (letra != t->saida_cor_letra) {
+    tela_saida_texto(primeiro ? "" : ";");
+    tela_saida_texto(tela_sgr_cor(letra, false));
+    primeiro = false;
+  }
+  if (fundo != t->saida_cor_fundo) {
+    tela_saida_texto(primeiro ? "" : ";");
+    tela_saida_texto(tela_sgr_cor(fundo, true));
+  }
+  tela_saida_texto("m");
+  t->saida_cor_letra = letra;
+  t->saida_cor_fundo = fundo;
+}
+
+static void tela_envia_celula(int lin, int col, const celula_t *c)
+{
+  if (lin != t->saida_lin || col != t->saida_col) {
+    tela_saida_formatada("\e[%d;%dH", lin + 1, col + 1);
+  }
+  tela_envia_cores(c->cor_letra, c->cor_fundo);
+  tela_saida_bytes(c->glifo, strnlen(c->glifo, sizeof(c->glifo)));
+  t->saida_lin = lin;
+  t->saida_col = col + 1;
+  if (t->saida_col >= t->grade_ncol) {
+    // na última coluna, a posição do cursor depende do terminal
+    t->saida_lin = t->saida_col = -1;
+  }
 }
 
 void tela_atualiza(void)
 {
+  // sem bloquear, só monta quadro novo quando o terminal já recebeu os
+  //   anteriores; senão o quadro fica retido na grade de desenho, e suas
+  //   mudanças vão junto com as do próximo
+  if (t->destino == SAIDA_TERMINAL && t->saida_pendente > 0) {
+    tela_saida_envia();
+    if (t->saida_pendente > 0) {
+      t->quadro_retido = true;
+      return;
+    }
+  }
+  t->quadro_retido = false;
+  tela_ajusta_grades();
+  if (t->redesenha_tudo) {
+    tela_saida_texto("\e[m\e[2J");
+    t->saida_cor_letra = t->saida_cor_fundo = COR_NORMAL;
+    t->saida_lin = t->saida_col = -1;
+    for (int i = 0; i < t->grade_nlin * t->grade_ncol; i++) {
+      t->visivel[i] = celula_vazia;
+    }
+    for (int lin = 0; lin < t->grade_nlin; lin++) {
+      t->linha_suja[lin] = true;
+    }
+    t->redesenha_tudo = false;
+  }
+  // envia somente as células que mudaram desde a última atualização; as
+  //   linhas não tocadas não mudaram, e uma linha tocada que ficou igual
+  //   é descartada inteira com memcmp antes de ser vista célula a célula
+  int ncol = t->grade_ncol;
+  for (int lin = 0; lin < t->grade_nlin; lin++) {
+    if (!t->linha_suja[lin]) {
+      continue;
+    }
+    t->linha_suja[lin] = false;
+    celula_t *visivel = &t->visivel[lin * ncol];
+    celula_t *desenho = &t->desenho[lin * ncol];
+    if (memcmp(visivel, desenho, ncol * sizeof(celula_t)) == 0) {
+      continue;
+    }
+    for (int col = 0; col < ncol; col++) {
+      if (!celulas_iguais(&visivel[col], &desenho[col])) {
+        tela_envia_celula(lin, col, &desenho[col]);
+        visivel[col] = desenho[col];
+      }
+    }
+  }
+  // deixa o cursor do terminal onde está o cursor de t->desenho
+  if (t->cursor_lin < t->grade_nlin && t->cursor_col < t->grade_ncol
+      && (t->cursor_lin != t->saida_lin || t->cursor_col != t->saida_col)) {
+    tela_saida_formatada("\e[%d;%dH", t->cursor_lin + 1, t->cursor_col + 1);
+    t->saida_lin = t->cursor_lin;
+    t->saida_col = t->cursor_col;
+  }
   // envia os dados de saída memorizados para a tela
-  fflush(stdout);
+  tela_saida_envia();
+}
+
+// flags de fd 1 antes de tela_nao_bloqueia(true), ou -1; como fd 1
+//   costuma dividir a descrição de arquivo com fd 0 e fd 2, O_NONBLOCK vale
+//   para os três, e as flags precisam voltar mesmo se o programa terminar
+//   sem passar por tela_nao_bloqueia(false)
+static volatile sig_atomic_t flags_saida = -1;
+
+// sinais que terminam o programa e que precisam restaurar as flags
+static const int sinais_fim[] = { SIGINT, SIGTERM, SIGHUP, SIGQUIT };
+#define N_SINAIS_FIM (int)(sizeof(sinais_fim) / sizeof(sinais_fim[0]))
+static struct sigaction tratadores_anteriores[N_SINAIS_FIM];
+
+// volta fd 1 às flags guardadas; só usa fcntl, que pode ser chamada num
+//   tratador de sinal
+static void tela_restaura_flags(void)
+{
+  if (flags_saida != -1) {
+    fcntl(1, F_SETFL, (int)flags_saida);
+    flags_saida = -1;
+  }
+}
+
+// tratador dos sinais de fim: restaura as flags e termina pelo sinal
+static void tela_sinal_fim(int sinal)
+{
+  tela_restaura_flags();
+  signal(sinal, SIG_DFL);
+  raise(sinal);
+}
+
+void tela_guarda_dados(void *dados, void (*libera)(void *dados))
+{
+  if (t->libera_dados != NULL) {
+    t->libera_dados(t->dados);
+  }
+  t->dados = dados;
+  t->libera_dados = libera;
+}
+
+void *tela_dados(void)
+{
+  return t->dados;
+}
+
+void tela_nao_bloqueia(bool nao_bloqueia)
+{
+  if (t != &tela_terminal || nao_bloqueia == t->nao_bloqueia) {
+    return;
+  }
+  if (nao_bloqueia) {
+    int flags = fcntl(1, F_GETFL);
+    if (flags == -1) {
+      return;
+    }
+    static bool registrado = false;
+    if (!registrado) {
+      atexit(tela_restaura_flags);
+      registrado = true;
+    }
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = tela_sinal_fim;
+    sigemptyset(&sa.sa_mask);
+    for (int i = 0; i < N_SINAIS_FIM; i++) {
+      sigaction(sinais_fim[i], &sa, &tratadores_anteriores[i]);
+    }
+    flags_saida = flags;
+    t->nao_bloqueia = true;
+    fcntl(1, F_SETFL, flags | O_NONBLOCK);
+    return;
+  }
+  t->nao_bloqueia = false;
+  tela_restaura_flags();
+  for (int i = 0; i < N_SINAIS_FIM; i++) {
+    sigaction(sinais_fim[i], &tratadores_anteriores[i], NULL);
+  }
+  // envia, esperando, o que estava guardado e o quadro retido
+  if (t->saida_pendente > 0) {
+    tela_saida_envia();
+  }
+  if (t->quadro_retido) {
+    tela_atualiza();
+  }
+}
+
+bool tela_atrasada(void)
+{
+  return t->destino == SAIDA_TERMINAL && (t->saida_pendente > 0 || t->quadro_retido);
+}
+
+void tela_invalida(void)
+{
+  t->redesenha_tudo = true;
+}
+
+void tela_estatisticas(tela_estatisticas_t *e)
+{
+  *e = t->estatisticas;
 }
 
 void tela_limpa(void)
 {
-  printf("\e[2J");
+  if (t == &tela_terminal) {
+    tela_verifica_tamanho();
+  }
+  tela_ajusta_grades();
+  // as linhas em que nada foi impresso já estão vazias
+  for (int lin = 0; lin < t->grade_nlin; lin++) {
+    if (t->linha_escrita[lin]) {
+      for (int col = 0; col < t->grade_ncol; col++) {
+        t->desenho[lin * t->grade_ncol + col] = celula_vazia;
+      }
+      t->linha_escrita[lin] = false;
+      t->linha_suja[lin] = true;
+    }
+  }
 }
 
 void tela_lincol(int lin, int col)
 {
-  printf("\e[%d;%dH", lin, col);
+  // como nas sequências ANSI, 0 e 1 são a primeira linha/coluna
+  t->cursor_lin = lin > 0 ? lin - 1 : 0;
+  t->cursor_col = col > 0 ? col - 1 : 0;
 }
 
-static int nlin, ncol; 
+// número de bytes do caractere UTF-8 que inicia com o byte b
+static int tam_utf8(unsigned char b)
+{
+  if (b >= 0xf0) return 4;
+  if (b >= 0xe0) return 3;
+  if (b >= 0xc0) return 2;
+  return 1;
+}
 
-static void tela_le_nlincol(int nada)
+void tela_escreve(const char *formato, ...)
 {
-  struct winsize tam;
-  bool ok = false;
-  // pede para o sistema o tamanho da janela de texto
-  int fd = open(ctermid(NULL), O_RDWR);
-  if (fd != -1) {
-    if (ioctl(fd, TIOCGWINSZ, &tam) == 0) {
-      nlin = tam.ws_row;
-      ncol = tam.ws_col;
-      if (nlin > 15 && ncol > 20) {
-        ok = true;
+  char texto[512];
+  va_list args;
+  va_start(args, formato);
+  vsnprintf(texto, sizeof(texto), formato, args);
+  va_end(args);
+
+  tela_ajusta_grades();
+  char *p = texto;
+  while (*p != '\0') {
+    if (*p == '\n') {
+      t->cursor_lin++;
+      t->cursor_col = 0;
+      p++;
+      continue;
+    }
+    int n = tam_utf8(*p);
+    if (t->cursor_lin < t->grade_nlin && t->cursor_col < t->grade_ncol) {
+      celula_t *c = &t->desenho[t->cursor_lin * t->grade_ncol + t->cursor_col];
+      memset(c->glifo, 0, sizeof(c->glifo));
+      for (int i = 0; i < n && p[i] != '\0'; i++) {
+        c->glifo[i] = p[i];
       }
+      c->cor_letra = t->cor_letra_atual;
+      c->cor_fundo = t->cor_fundo_atual;
+      t->linha_suja[t->cursor_lin] = t->linha_escrita[t->cursor_lin] = true;
+    }
+    t->cursor_col++;
+    for (int i = 0; i < n && *p != '\0'; i++) {
+      p++;
     }
   }
-  if (!ok) {
-    nlin = 24;
-    ncol = 80;
-    printf("Não consegui identificar tamanho do terminal, usando %dx%d\n",
-        nlin, ncol);
+}
+
+// lê o tamanho do terminal; se não conseguir, ou se for pequeno demais,
+//   usa 24x80 e retorna false
+static bool tela_le_nlincol(void)
+{
+  struct winsize tam;
+  // pede para o sistema o tamanho da janela de texto, no terminal onde
+  //   a tela é escrita
+  if (ioctl(1, TIOCGWINSZ, &tam) == 0 && tam.ws_row > 15 && tam.ws_col > 20) {
+    tela_terminal.nlin = tam.ws_row;
+    tela_terminal.ncol = tam.ws_col;
+    return true;
+  }
+  tela_terminal.nlin = 24;
+  tela_terminal.ncol = 80;
+  return false;
+}
+
+bool tela_verifica_tamanho(void)
+{
+  if (pipe_tamanho[0] == -1) {
+    return false;
+  }
+  // esvazia o pipe: todos os avisos acumulados valem por um
+  char avisos[64];
+  bool avisado = false;
+  while (read(pipe_tamanho[0], avisos, sizeof(avisos)) > 0) {
+    avisado = true;
+  }
+  if (!avisado) {
+    return false;
   }
+  int nlin = tela_terminal.nlin, ncol = tela_terminal.ncol;
+  tela_le_nlincol();
+  return tela_terminal.nlin != nlin || tela_terminal.ncol != ncol;
 }
 
 int tela_nlin(void)
 {
-  return nlin;
+  return t->nlin;
 }
 
 int tela_ncol(void)
 {
-  return ncol;
+  return t->ncol;
 }
 
 void tela_cor_normal(void)
 {
-  printf("\e[m");
+  t->cor_letra_atual = COR_NORMAL;
+  t->cor_fundo_atual = COR_NORMAL;
 }
 
 void tela_cor_letra(int vermelho, int verde, int azul)
 {
-  printf("\e[38;2;%d;%d;%dm", vermelho, verde, azul);
+  t->cor_letra_atual = (vermelho & 0xff) << 16 | (verde & 0xff) << 8 | (azul & 0xff);
 }
 
 void tela_cor_fundo(int vermelho, int verde, int azul)
 {
-  printf("\e[48;2;%d;%d;%dm", vermelho, verde, azul);
+  t->cor_fundo_atual = (vermelho & 0xff) << 16 | (verde & 0xff) << 8 | (azul & 0xff);
 }
 
 
 double tela_relogio(void)
 {
   struct timespec agora;
-  clock_gettime(CLOCK_REALTIME, &agora);
+  clock_gettime(CLOCK_MONOTONIC, &agora);
   return agora.tv_sec + agora.tv_nsec*1e-9;
 }
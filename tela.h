@@ -14,6 +14,10 @@
 // inicializa a tela
 void tela_ini(void);
 
+// inicializa a tela com o tamanho dado, sem terminal: os quadros são
+// descartados, mas contados em tela_estatisticas como se fossem enviados
+void tela_ini_memoria(int nlin, int ncol);
+
 // volta a tela ao normal
 void tela_fim(void);
 
@@ -23,12 +27,22 @@ void tela_limpa(void);
 // posiciona o cursor (0,0 é o canto superior esquerdo)
 void tela_lincol(int lin, int col);
 
+// escreve na posição do cursor, com as cores selecionadas; os argumentos
+// são como os de printf. O cursor avança uma coluna por caractere.
+void tela_escreve(const char *formato, ...);
+
 // retorna a altura da tela (número de linhas)
 int tela_nlin(void);
 
 // retorna a largura da tela (número de colunas)
 int tela_ncol(void);
 
+// atualiza o tamanho da tela do terminal, se ele mudou de tamanho desde a
+//   última verificação (várias mudanças seguidas contam como uma só)
+// retorna true se o tamanho mudou
+// é chamada por tela_limpa; o laço do jogo pode chamá-la uma vez por quadro
+bool tela_verifica_tamanho(void);
+
 // cor normal para as próximas impressões
 void tela_cor_normal(void);
 
@@ -46,9 +60,75 @@ void tela_mostra_cursor(bool mostra);
 // para melhorar a apresentação na tela, os dados impressos são
 // mantidos em memória para serem enviados agrupados ao sistema.
 // Esta função deve ser chamada quando for necessário que os dados
-// sejam enviados e efetivamente apareçam
+// sejam enviados e efetivamente apareçam. Somente as posições da tela
+// que mudaram desde a última chamada são enviadas.
 void tela_atualiza(void);
 
+// faz os envios ao terminal não esperarem por ele: o que o terminal não
+//   aceitar fica guardado, e enquanto houver algo guardado tela_atualiza
+//   não monta quadro novo (as mudanças vão juntas no próximo quadro enviado)
+// com false, volta a esperar, enviando antes o que estava guardado; deve
+//   ser false fora do laço do jogo (menus, leitura do nome)
+// atenção: num terminal, fd 1 costuma dividir a descrição de arquivo com
+//   fd 0 e fd 2, então a entrada e a saída de erros também deixam de
+//   esperar. As flags originais voltam com false, em tela_fim, ao sair com
+//   exit e em SIGINT, SIGTERM, SIGHUP e SIGQUIT
+void tela_nao_bloqueia(bool nao_bloqueia);
+
+// retorna true se há dados guardados ou um quadro retido esperando o
+//   terminal; tela_atualiza tenta enviá-los
+bool tela_atrasada(void);
+
+// faz com que a próxima chamada a tela_atualiza envie a tela toda; deve
+// ser chamada quando algo aparecer na tela sem ter passado por aqui (o
+// eco do terminal, por exemplo)
+void tela_invalida(void);
+
+// contadores do envio de dados ao terminal
+typedef struct {
+  long escritas;        // chamadas a write na última atualização
+  long bytes;           // bytes enviados na última atualização
+  long quadros;         // número de atualizações desde o início
+  long total_escritas;  // chamadas a write desde o início
+  long total_bytes;     // bytes enviados desde o início
+} tela_estatisticas_t;
+
+// copia para *e os contadores de envio de dados ao terminal
+void tela_estatisticas(tela_estatisticas_t *e);
+
+// uma tela que não é a do terminal, usada por quem desenha para outros
+//   (o servidor, para cada jogador conectado)
+typedef struct tela tela_t;
+
+// cria uma tela em memória com o tamanho dado; os quadros de tela_atualiza
+//   ficam acumulados até serem entregues (ver tela_pendente)
+// retorna NULL se não houver memória
+tela_t *tela_cria(int nlin, int ncol);
+
+// libera uma tela criada com tela_cria
+void tela_destroi(tela_t *tela);
+
+// faz as próximas chamadas das funções de tela atuarem sobre a tela dada
+//   (NULL para a tela do terminal)
+// retorna a tela que estava selecionada (NULL se era a do terminal)
+tela_t *tela_seleciona(tela_t *tela);
+
+// retorna os bytes dos quadros da tela selecionada que ainda não foram
+//   entregues, e coloca em *n quantos são
+const char *tela_pendente(int *n);
+
+// informa que os n primeiros bytes pendentes foram entregues
+void tela_entregue(int n);
+
+// guarda junto com a tela selecionada dados de quem desenha nela (por
+//   exemplo, posições calculadas para o tamanho dessa tela); libera é
+//   chamada com os dados anteriores, e com estes quando a tela é destruída
+//   ou termina (tela_fim)
+void tela_guarda_dados(void *dados, void (*libera)(void *dados));
+
+// retorna os dados guardados com a tela selecionada, ou NULL
+void *tela_dados(void);
+
 // retorna o número de segundos desde algum momento no passado
 double tela_relogio(void);
 